@@ -0,0 +1,71 @@
+"""Generates the stop word header consumed by src/tokenizer/tokenizer_rules.hpp.
+
+The perfect hash over the words is computed by the compiler (see
+src/tokenizer/stop_word_filter.hpp), so this script only has to emit the list.
+
+Usage: python generate_stop_words.py <words.txt> <stop_words.hpp>
+Expects a text file with one stop word per line; empty lines and lines starting
+with '#' are ignored.
+"""
+import sys
+
+# Keep in sync with make_delims() in src/tokenizer/tokenizer_rules.hpp.
+TOKEN_CHARS = set("abcdefghijklmnopqrstuvwxyz0123456789$%&+@")
+COLUMN_LIMIT = 100
+
+
+def read_words(path):
+    words = []
+    seen = set()
+    with open(path) as file:
+        for line in file:
+            word = line.strip().lower()
+            if not word or word.startswith("#") or word in seen:
+                continue
+            invalid = set(word) - TOKEN_CHARS
+            if invalid:
+                sys.exit(f"Stop word '{word}' can never be produced by the tokenizer "
+                         f"(characters {''.join(sorted(invalid))})")
+            seen.add(word)
+            words.append(word)
+    return words
+
+
+def render(words):
+    quoted = [f'"{word}",' for word in words]
+    width = max(len(q) for q in quoted) + 1
+    words_per_line = max(1, (COLUMN_LIMIT - 4) // width)
+    lines = []
+    for i in range(0, len(quoted), words_per_line):
+        chunk = quoted[i:i + words_per_line]
+        lines.append("    " + "".join(q.ljust(width) for q in chunk).rstrip())
+    body = "\n".join(lines)
+    return f"""// Generated by scripts/generate_stop_words.py. Do not edit by hand.
+#ifndef STOP_WORDS_HPP
+#define STOP_WORDS_HPP
+//---------------------------------------------------------------------------
+#include <array>
+#include <string_view>
+//---------------------------------------------------------------------------
+namespace tokenizer {{
+//---------------------------------------------------------------------------
+inline constexpr std::array<std::string_view, {len(words)}> STOP_WORDS = {{
+{body}
+}};
+//---------------------------------------------------------------------------
+}}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // STOP_WORDS_HPP
+"""
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("Usage: python generate_stop_words.py <words.txt> <stop_words.hpp>")
+        sys.exit(1)
+
+    words = read_words(sys.argv[1])
+    if not words:
+        sys.exit("The stop word list is empty")
+    with open(sys.argv[2], "w") as output:
+        output.write(render(words))
@@ -0,0 +1,208 @@
+#include "index_segment.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+#include "data-structures/term_counter.hpp"
+#include "documents/document_iterator.hpp"
+#include "tokenizer/batch_tokenizer.hpp"
+
+namespace {
+
+/// Hashes std::string keys, so they can be looked up by std::string_view.
+struct TokenHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view token) const { return std::hash<std::string_view>{}(token); }
+};
+
+}  // namespace
+
+IndexSegment::IndexSegment(const std::string &data_path, tokenizer::StemCache *stem_cache,
+                           bool unicode, uint64_t num_threads) {
+  DocumentIterator doc_it(data_path);
+
+  // Every thread indexes its batches into its own postings
+  using ThreadPostings = std::unordered_map<std::string, Postings, TokenHash, std::equal_to<>>;
+  std::vector<ThreadPostings> thread_postings(num_threads);
+  std::vector<std::vector<std::pair<DocumentID, uint32_t>>> thread_lengths(num_threads);
+
+  auto index_batches = [&](size_t thread_id) {
+    tokenizer::BatchTokenizer tokenizer(true, true, stem_cache, unicode);
+    tokenizer::TokenBatch tokens;
+    TermCounter term_counter;
+    ThreadPostings &postings = thread_postings[thread_id];
+    for (auto batch = doc_it.next(); !batch.empty(); batch = doc_it.next()) {
+      tokenizer.tokenize(batch, tokens);
+      for (size_t doc_index = 0; doc_index < batch.size(); ++doc_index) {
+        DocumentID doc_id = batch[doc_index].getId();
+        uint32_t first_token = tokens.doc_offsets[doc_index];
+        uint32_t last_token = tokens.doc_offsets[doc_index + 1];
+
+        term_counter.clear();
+        for (uint32_t i = first_token; i < last_token; ++i) {
+          term_counter.add(tokens.token(i));
+        }
+        thread_lengths[thread_id].emplace_back(doc_id, last_token - first_token);
+
+        for (const auto &[token, freq] : term_counter) {
+          auto it = postings.find(token);
+          if (it == postings.end()) {
+            it = postings.try_emplace(std::string(token)).first;
+          }
+          it->second.emplace_back(doc_id, freq);
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(index_batches, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Combine the threads' postings, which each cover other documents
+  for (auto &postings : thread_postings) {
+    for (auto &[token, appearances] : postings) {
+      Postings &merged = postings_[token];
+      merged.insert(merged.end(), appearances.begin(), appearances.end());
+    }
+    postings = {};
+  }
+  for (auto &[token, appearances] : postings_) {
+    std::sort(appearances.begin(), appearances.end());
+    appearances.shrink_to_fit();
+  }
+
+  DocumentID last_doc_id = 0;
+  first_doc_id_ = std::numeric_limits<DocumentID>::max();
+  for (const auto &lengths : thread_lengths) {
+    for (const auto &[doc_id, length] : lengths) {
+      first_doc_id_ = std::min(first_doc_id_, doc_id);
+      last_doc_id = std::max(last_doc_id, doc_id);
+      ++document_count_;
+      token_count_ += length;
+    }
+  }
+  if (document_count_ == 0) {
+    first_doc_id_ = 0;
+    return;
+  }
+  doc_lengths_.resize(last_doc_id - first_doc_id_ + 1);
+  doc_ids_.reserve(document_count_);
+  for (const auto &lengths : thread_lengths) {
+    for (const auto &[doc_id, length] : lengths) {
+      doc_lengths_[doc_id - first_doc_id_] = length;
+      doc_ids_.push_back(doc_id);
+    }
+  }
+  std::sort(doc_ids_.begin(), doc_ids_.end());
+  deleted_.resize(doc_lengths_.size());
+}
+
+IndexSegment::IndexSegment(const std::vector<std::shared_ptr<const IndexSegment>> &segments) {
+  // Only the live documents are kept
+  for (const auto &segment : segments) {
+    for (DocumentID doc_id : segment->doc_ids_) {
+      if (!segment->isDeleted(doc_id)) {
+        doc_ids_.push_back(doc_id);
+        token_count_ += segment->getDocumentLength(doc_id);
+      }
+    }
+  }
+  if (doc_ids_.empty()) {
+    return;
+  }
+  std::sort(doc_ids_.begin(), doc_ids_.end());
+  document_count_ = static_cast<uint32_t>(doc_ids_.size());
+  first_doc_id_ = doc_ids_.front();
+  doc_lengths_.resize(doc_ids_.back() - first_doc_id_ + 1);
+  deleted_.resize(doc_lengths_.size());
+  for (const auto &segment : segments) {
+    for (DocumentID doc_id : segment->doc_ids_) {
+      if (!segment->isDeleted(doc_id)) {
+        doc_lengths_[doc_id - first_doc_id_] = segment->getDocumentLength(doc_id);
+      }
+    }
+  }
+
+  for (const auto &segment : segments) {
+    for (const auto &[token, appearances] : segment->postings_) {
+      Postings &merged = postings_[token];
+      for (const auto &posting : appearances) {
+        if (!segment->isDeleted(posting.first)) {
+          merged.push_back(posting);
+        }
+      }
+    }
+  }
+  // The segments may cover overlapping document id ranges
+  for (auto it = postings_.begin(); it != postings_.end();) {
+    Postings &appearances = it->second;
+    if (appearances.empty()) {
+      it = postings_.erase(it);
+      continue;
+    }
+    if (!std::is_sorted(appearances.begin(), appearances.end())) {
+      std::sort(appearances.begin(), appearances.end());
+    }
+    appearances.shrink_to_fit();
+    ++it;
+  }
+}
+
+const IndexSegment::Postings *IndexSegment::find(const std::string &token) const {
+  auto it = postings_.find(token);
+  return it == postings_.end() ? nullptr : &it->second;
+}
+
+bool IndexSegment::deleteDocument(DocumentID doc_id) const {
+  if (!std::binary_search(doc_ids_.begin(), doc_ids_.end(), doc_id) ||
+      !deleted_.erase(doc_id - first_doc_id_)) {
+    return false;
+  }
+  deleted_tokens_ += getDocumentLength(doc_id);
+  return true;
+}
+
+bool IndexSegment::contains(DocumentID doc_id) const {
+  return std::binary_search(doc_ids_.begin(), doc_ids_.end(), doc_id) && !isDeleted(doc_id);
+}
+
+const std::vector<DocumentID> &IndexSegment::getDocumentIds() const { return doc_ids_; }
+
+uint32_t IndexSegment::getDocumentCount() const { return document_count_; }
+
+uint32_t IndexSegment::getDeletedCount() const {
+  return static_cast<uint32_t>(deleted_.count());
+}
+
+uint64_t IndexSegment::getTokenCount() const { return token_count_; }
+
+uint64_t IndexSegment::getDeletedTokenCount() const { return deleted_tokens_; }
+
+uint64_t IndexSegment::footprint_size() const {
+  uint64_t size = doc_lengths_.size() * sizeof(uint32_t) +
+                  doc_ids_.size() * sizeof(DocumentID) + deleted_.footprint() +
+                  sizeof(IndexSegment);
+  for (const auto &[token, appearances] : postings_) {
+    size += sizeof(std::pair<const std::string, Postings>) + token.size() +
+            appearances.size() * sizeof(std::pair<DocumentID, uint32_t>);
+  }
+  return size;
+}
+
+uint64_t IndexSegment::footprint_capacity() const {
+  uint64_t size = doc_lengths_.capacity() * sizeof(uint32_t) +
+                  doc_ids_.capacity() * sizeof(DocumentID) + deleted_.footprint() +
+                  sizeof(IndexSegment) + postings_.bucket_count() * sizeof(void *);
+  for (const auto &[token, appearances] : postings_) {
+    size += sizeof(std::pair<const std::string, Postings>) + sizeof(void *) + token.capacity() +
+            appearances.capacity() * sizeof(std::pair<DocumentID, uint32_t>);
+  }
+  return size;
+}
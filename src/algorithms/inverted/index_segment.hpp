@@ -0,0 +1,100 @@
+#ifndef INDEX_SEGMENT_HPP
+#define INDEX_SEGMENT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "data-structures/tombstones.hpp"
+#include "fts_engine.hpp"
+#include "tokenizer/stem_cache.hpp"
+
+/**
+ * An immutable part of the index of a SegmentedIndexEngine.
+ *
+ * Holds the posting lists and document lengths of the documents added at once, or of
+ * several merged segments. Apart from their tombstones, segments are never changed once
+ * built, so queries can read them while newer segments are added and older ones are
+ * merged. Merging drops the deleted documents.
+ */
+class IndexSegment {
+ public:
+  using Postings = std::vector<std::pair<DocumentID, uint32_t>>;
+
+  /// Indexes the documents of a Parquet file or directory on num_threads threads.
+  IndexSegment(const std::string &data_path, tokenizer::StemCache *stem_cache, bool unicode,
+               uint64_t num_threads);
+
+  /// Merges the live documents of segments into one.
+  explicit IndexSegment(const std::vector<std::shared_ptr<const IndexSegment>> &segments);
+
+  /// Get the postings of a token sorted by document id, nullptr if no document has it.
+  [[nodiscard]] const Postings *find(const std::string &token) const;
+
+  /// Get the number of tokens of a document of this segment.
+  [[nodiscard]] uint32_t getDocumentLength(DocumentID doc_id) const {
+    return doc_lengths_[doc_id - first_doc_id_];
+  }
+
+  /// Marks a document deleted, false if it isn't in this segment or already deleted.
+  /// May run concurrently with queries.
+  bool deleteDocument(DocumentID doc_id) const;
+
+  /// Whether a document with this id is in this segment and not deleted.
+  [[nodiscard]] bool contains(DocumentID doc_id) const;
+
+  /// Whether a document of this segment is deleted.
+  [[nodiscard]] bool isDeleted(DocumentID doc_id) const {
+    return deleted_.contains(doc_id - first_doc_id_);
+  }
+
+  /// Get the ids of the documents, sorted.
+  [[nodiscard]] const std::vector<DocumentID> &getDocumentIds() const;
+
+  /// Get the number of documents, including the deleted ones.
+  [[nodiscard]] uint32_t getDocumentCount() const;
+
+  /// Get the number of deleted documents.
+  [[nodiscard]] uint32_t getDeletedCount() const;
+
+  /// Get the number of tokens of all documents, including the deleted ones.
+  [[nodiscard]] uint64_t getTokenCount() const;
+
+  /// Get the number of tokens of the deleted documents.
+  [[nodiscard]] uint64_t getDeletedTokenCount() const;
+
+  [[nodiscard]] uint64_t footprint_size() const;
+
+  [[nodiscard]] uint64_t footprint_capacity() const;
+
+ private:
+  /// key is token, value is its postings sorted by document id
+  std::unordered_map<std::string, Postings> postings_;
+
+  /// the smallest document id of this segment
+  DocumentID first_doc_id_ = 0;
+
+  /// key is document id - first_doc_id_, value is number of tokens
+  std::vector<uint32_t> doc_lengths_;
+
+  /// the ids of the documents, sorted
+  std::vector<DocumentID> doc_ids_;
+
+  /// the deleted documents by document id - first_doc_id_
+  mutable Tombstones deleted_;
+
+  /// number of tokens of the deleted documents
+  mutable std::atomic<uint64_t> deleted_tokens_ = 0;
+
+  /// number of documents
+  uint32_t document_count_ = 0;
+
+  /// number of tokens of all documents
+  uint64_t token_count_ = 0;
+};
+
+#endif  // INDEX_SEGMENT_HPP
@@ -2,25 +2,75 @@
 
 #include "inverted_index_engine.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 
 #include "datastructures/hyperloglog.hpp"
 #include "documents/document_iterator.hpp"
+#include "queries/worker_pool.hpp"
+#include "tokenizer/batch_tokenizer.hpp"
 #include "tokenizer/simpletokenizer.hpp"
 #include "tokenizer/stemmingtokenizer.hpp"
+#include "tokenizer/utf8tokenizer.hpp"
+
+InvertedIndexEngine::InvertedIndexEngine(bool use_stem_cache, bool unicode,
+                                         uint32_t query_threads, uint64_t score_cache_bytes,
+                                         Precision precision, bool reorder_documents)
+    : stem_cache_(use_stem_cache ? std::make_unique<tokenizer::StemCache>() : nullptr),
+      unicode_(unicode),
+      query_threads_(std::max(query_threads, 1u)),
+      score_cache_(score_cache_bytes > 0 ? std::make_unique<ScoreCache>(score_cache_bytes)
+                                         : nullptr),
+      precision_(precision),
+      reorder_documents_(reorder_documents) {
+  queries::WorkerPool::shared().reserve(query_threads_ - 1);
+}
 
 void InvertedIndexEngine::indexDocuments(std::string &data_path) {
+  packed_postings_ = {};
+  posting_lists_ = {};
   estimateDataStructureSizes(data_path);
 
   DocumentIterator doc_it(data_path);
+  spill_statistics_ = {};
+  if (memory_budget_ > 0) {
+    indexSpilling(doc_it);
+  } else {
+    indexAll(doc_it);
+  }
+
+  finalize();
+  original_ids_.clear();
+  internal_ids_.clear();
+  if (reorder_documents_) {
+    reorderDocuments();
+  }
+  deleted_.resize(0);
+  deleted_.resize(tokens_per_document_.size());
+  deleted_tokens_ = 0;
+  num_tokens_ = std::accumulate(tokens_per_document_.begin(), tokens_per_document_.end(),
+                                uint64_t{0});
+  discardScoreData();
+}
 
+void InvertedIndexEngine::indexAll(DocumentIterator &doc_it) {
   auto index_batches = [&doc_it, this]() {
+    tokenizer::BatchTokenizer tokenizer(true, true, stem_cache_.get(), unicode_);
+    tokenizer::TokenBatch tokens;
+    TermCounter term_counter;
     std::vector<Document> cur_batch = doc_it.next();
     while (!cur_batch.empty()) {
-      indexBatch(cur_batch);
+      indexBatch(cur_batch, tokenizer, tokens, term_counter);
       cur_batch = doc_it.next();
     }
   };
@@ -34,28 +84,545 @@ void InvertedIndexEngine::indexDocuments(std::string &data_path) {
   }
 }
 
-void InvertedIndexEngine::indexBatch(const std::vector<Document> &batch) {
-  for (const Document &doc : batch) {
-    uint32_t num_tokens = 0;
-    std::unordered_map<std::string, uint32_t> local_term_frequency_per_document{};
+void InvertedIndexEngine::indexSpilling(DocumentIterator &doc_it) {
+  SortedRuns<std::string, std::pair<DocumentID, uint32_t>> runs(spill_directory_);
+  // Rough heap size of a token's node in the postings of a thread
+  constexpr uint64_t kNodeBytes = sizeof(std::pair<const std::string, Postings>) + 32;
+  uint64_t thread_budget = std::max<uint64_t>(memory_budget_ / NUM_THREADS, 1);
+
+  auto index_batches = [&]() {
+    tokenizer::BatchTokenizer tokenizer(true, true, stem_cache_.get(), unicode_);
+    tokenizer::TokenBatch tokens;
+    TermCounter term_counter;
+    std::unordered_map<std::string, Postings, Hasher<std::string>, std::equal_to<>> postings;
+    uint64_t used_bytes = 0;
+
+    auto spill = [&]() {
+      std::vector<std::pair<std::string, Postings>> entries;
+      entries.reserve(postings.size());
+      while (!postings.empty()) {
+        auto node = postings.extract(postings.begin());
+        entries.emplace_back(std::move(node.key()), std::move(node.mapped()));
+      }
+      runs.write(entries);
+      postings = {};
+      used_bytes = 0;
+    };
+
+    for (auto batch = doc_it.next(); !batch.empty(); batch = doc_it.next()) {
+      tokenizer.tokenize(batch, tokens);
+      for (size_t doc_index = 0; doc_index < batch.size(); ++doc_index) {
+        DocumentID doc_id = batch[doc_index].getId();
+        uint32_t first_token = tokens.doc_offsets[doc_index];
+        uint32_t last_token = tokens.doc_offsets[doc_index + 1];
+
+        term_counter.clear();
+        for (uint32_t i = first_token; i < last_token; ++i) {
+          term_counter.add(tokens.token(i));
+        }
+        tokens_per_document_[doc_id] = last_token - first_token;
+
+        for (const auto &[token, freq] : term_counter) {
+          auto it = postings.find(token);
+          if (it == postings.end()) {
+            it = postings.try_emplace(std::string(token)).first;
+            used_bytes += kNodeBytes + token.size();
+          }
+          size_t capacity = it->second.capacity();
+          it->second.emplace_back(doc_id, freq);
+          used_bytes += (it->second.capacity() - capacity) * sizeof(Postings::value_type);
+        }
+      }
+      if (used_bytes >= thread_budget) {
+        spill();
+      }
+    }
+    if (!postings.empty()) {
+      spill();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < NUM_THREADS; i++) {
+    threads.emplace_back(index_batches);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // The merged runs are packed right away, so every posting is copied once
+  packed_postings_.reserve(runs.getPostingCount());
+  runs.merge([this](const std::string &token, const Postings &postings) {
+    packed_postings_.add(token, postings);
+    posting_lists_.emplace_back().document_frequency = static_cast<uint32_t>(postings.size());
+  });
+  // The runs of the threads overlap in their documents, so the merged lists are sorted
+  parallelFor(posting_lists_.size(), [this](size_t index, size_t) {
+    std::span<Posting> postings = packed_postings_.postings(static_cast<uint32_t>(index));
+    std::sort(postings.begin(), postings.end());
+    posting_lists_[index].postings = postings;
+  });
+  spill_statistics_ = runs.getStatistics();
+}
+
+void InvertedIndexEngine::setMemoryBudget(uint64_t budget_bytes,
+                                          const std::string &spill_directory) {
+  memory_budget_ = budget_bytes;
+  spill_directory_ = spill_directory;
+}
+
+const SpillStatistics &InvertedIndexEngine::getSpillStatistics() const {
+  return spill_statistics_;
+}
+
+void InvertedIndexEngine::discardScoreData() {
+  if (score_cache_) {
+    score_cache_->clear();
+  }
+  impact_scorer_.clear();
+  impact_ordered_ = false;
+  max_score_scorer_.clear();
+  markIndexChanged();
+}
+
+bool InvertedIndexEngine::deleteDocument(DocumentID doc_id) {
+  if (!original_ids_.empty()) {
+    if (doc_id >= internal_ids_.size()) {
+      return false;
+    }
+    doc_id = internal_ids_[doc_id];
+  }
+  // Gaps in the document ids have no tokens
+  if (doc_id >= tokens_per_document_.size() || tokens_per_document_[doc_id] == 0 ||
+      !deleted_.erase(doc_id)) {
+    return false;
+  }
+  deleted_tokens_ += tokens_per_document_[doc_id];
+  markIndexChanged();
+  return true;
+}
+
+void InvertedIndexEngine::updateDocuments(const std::string &data_path) {
+  if (!original_ids_.empty()) {
+    throw std::logic_error("Renumbered documents can't be updated!");
+  }
+
+  std::vector<DocumentID> doc_ids;
+  {
+    DocumentIterator doc_it(data_path);
+    for (auto batch = doc_it.next(); !batch.empty(); batch = doc_it.next()) {
+      for (const auto &doc : batch) {
+        doc_ids.push_back(doc.getId());
+      }
+    }
+  }
+  if (doc_ids.empty()) {
+    return;
+  }
+  DocumentID max_doc_id = *std::max_element(doc_ids.begin(), doc_ids.end());
+  if (max_doc_id >= tokens_per_document_.size()) {
+    tokens_per_document_.resize(max_doc_id + 1);
+    deleted_.resize(max_doc_id + 1);
+  }
+
+  // Drop the postings of the old versions
+  for (DocumentID doc_id : doc_ids) {
+    deleteDocument(doc_id);
+  }
+  compact();
+  for (DocumentID doc_id : doc_ids) {
+    if (deleted_.revive(doc_id)) {
+      deleted_tokens_ -= tokens_per_document_[doc_id];
+    }
+  }
+
+  // The new versions mostly contain known tokens
+  term_frequency_per_document_ =
+      ParallelHashTable<std::string, PostingList>{posting_lists_.size(), &table_arena_};
+  DocumentIterator doc_it(data_path);
+  indexAll(doc_it);
+  finalize();
+  num_tokens_ = std::accumulate(tokens_per_document_.begin(), tokens_per_document_.end(),
+                                uint64_t{0});
+  discardScoreData();
+}
+
+void InvertedIndexEngine::compact() {
+  removePostings([this](uint32_t index, const Posting &posting) {
+    if (!deleted_.contains(posting.first)) {
+      return false;
+    }
+    --posting_lists_[index].document_frequency;
+    return true;
+  });
+  discardScoreData();
+}
+
+uint64_t InvertedIndexEngine::removePostings(
+    const std::function<bool(uint32_t, const Posting &)> &remove) {
+  uint64_t num_removed = packed_postings_.removeIf(remove);
+  for (uint32_t index = 0; index < posting_lists_.size(); ++index) {
+    PostingList &list = posting_lists_[index];
+    list.postings = packed_postings_.postings(index);
+
+    // The impacts refer to the removed postings
+    list.impacts = {};
+    list.impact_ordered = {};
+    list.impact_groups = {};
+    list.max_score = 0.0;
+  }
+  return num_removed;
+}
+
+void InvertedIndexEngine::parallelFor(size_t count,
+                                      const std::function<void(size_t, size_t)> &fn) {
+  auto process_indexes = [count, &fn, this](size_t thread_id) {
+    for (size_t i = thread_id; i < count; i += NUM_THREADS) {
+      fn(i, thread_id);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < NUM_THREADS; i++) {
+    threads.emplace_back(process_indexes, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void InvertedIndexEngine::forEachPostingList(
+    const std::function<void(PostingList &, size_t)> &fn) {
+  parallelFor(posting_lists_.size(), [&fn, this](size_t index, size_t thread_id) {
+    fn(posting_lists_[index], thread_id);
+  });
+}
+
+void InvertedIndexEngine::finalize() {
+  // The tables of builds adding nothing, e.g. merging spilled runs, are only freed
+  if (term_frequency_per_document_.begin() != term_frequency_per_document_.end()) {
+    // Every packed list starts with its old postings, if any, followed by the added ones
+    uint64_t num_postings = packed_postings_.getPostingCount();
+    for (auto &[token, list] : term_frequency_per_document_) {
+      num_postings += list.added.size();
+    }
+    PackedPostings<std::string, Posting> packed;
+    packed.reserve(num_postings);
+    std::vector<PostingList> lists;
+    std::vector<std::pair<uint32_t, PostingList *>> sources;
+    for (uint32_t index = 0; index < packed_postings_.size(); ++index) {
+      const std::string &token = packed_postings_.key(index);
+      PostingList *added = term_frequency_per_document_.get(token);
+      uint64_t count = posting_lists_[index].postings.size();
+      lists.push_back(std::move(posting_lists_[index]));
+      if (added != nullptr) {
+        count += added->added.size();
+        lists.back().document_frequency += added->document_frequency;
+      }
+      packed.add(token, count);
+      sources.emplace_back(index, added);
+    }
+    for (auto &[token, list] : term_frequency_per_document_) {
+      if (packed_postings_.find(token) == packed_postings_.kNotFound) {
+        packed.add(token, list.added.size());
+        lists.emplace_back().document_frequency = list.document_frequency;
+        sources.emplace_back(packed_postings_.kNotFound, &list);
+      }
+    }
+
+    // The threads append their batches in any order
+    parallelFor(lists.size(), [&](size_t index, size_t) {
+      std::span<Posting> postings = packed.postings(index);
+      auto [old_index, added] = sources[index];
+      Posting *out = postings.data();
+      if (old_index != packed_postings_.kNotFound) {
+        out = std::copy(lists[index].postings.begin(), lists[index].postings.end(), out);
+      }
+      if (added != nullptr) {
+        added->added.copyTo(out);
+        added->added.clear(build_arena_);
+      }
+      std::sort(postings.begin(), postings.end());
+      lists[index].postings = postings;
+    });
+    packed_postings_ = std::move(packed);
+    posting_lists_ = std::move(lists);
+  }
+
+  // The chains of the table are freed with it
+  term_frequency_per_document_ = ParallelHashTable<std::string, PostingList>{1};
+  table_arena_.release();
+  build_arena_.release();
+}
+
+void InvertedIndexEngine::reorderDocuments() {
+  // The smallest token hash of every document under kNumHashes hash functions
+  constexpr size_t kNumHashes = 4;
+  size_t num_docs = tokens_per_document_.size();
+  std::vector<std::array<uint32_t, kNumHashes>> signatures(num_docs);
+  for (auto &signature : signatures) {
+    signature.fill(std::numeric_limits<uint32_t>::max());
+  }
+  for (uint32_t index = 0; index < posting_lists_.size(); ++index) {
+    const PostingList &list = posting_lists_[index];
+    // Derive the hash functions from two halves (Kirsch and Mitzenmacher)
+    uint64_t hash = std::hash<std::string>{}(packed_postings_.key(index));
+    auto first = static_cast<uint32_t>(hash);
+    auto second = static_cast<uint32_t>(hash >> 32) | 1;
+    std::array<uint32_t, kNumHashes> token_hashes;
+    for (size_t i = 0; i < kNumHashes; ++i) {
+      token_hashes[i] = first + static_cast<uint32_t>(i) * second;
+    }
+    for (const auto &[doc_id, freq] : list.postings) {
+      for (size_t i = 0; i < kNumHashes; ++i) {
+        signatures[doc_id][i] = std::min(signatures[doc_id][i], token_hashes[i]);
+      }
+    }
+  }
+
+  // Documents with equal signatures likely share most tokens
+  original_ids_.resize(num_docs);
+  std::iota(original_ids_.begin(), original_ids_.end(), 0);
+  std::sort(original_ids_.begin(), original_ids_.end(), [&](DocumentID lhs, DocumentID rhs) {
+    return std::tie(signatures[lhs], lhs) < std::tie(signatures[rhs], rhs);
+  });
+  internal_ids_.resize(num_docs);
+  for (size_t i = 0; i < num_docs; ++i) {
+    internal_ids_[original_ids_[i]] = static_cast<DocumentID>(i);
+  }
+
+  forEachPostingList([this](PostingList &list, size_t) {
+    for (auto &[doc_id, freq] : list.postings) {
+      doc_id = internal_ids_[doc_id];
+    }
+    std::sort(list.postings.begin(), list.postings.end());
+  });
+  std::vector<uint32_t> tokens_per_document(num_docs);
+  for (size_t i = 0; i < num_docs; ++i) {
+    tokens_per_document[i] = tokens_per_document_[original_ids_[i]];
+  }
+  tokens_per_document_ = std::move(tokens_per_document);
+}
+
+double InvertedIndexEngine::getAverageGapBits() {
+  std::vector<std::pair<uint64_t, uint64_t>> totals(NUM_THREADS);
+  forEachPostingList([&totals](PostingList &list, size_t thread_id) {
+    // The first gap is counted from -1, so every gap is positive
+    int64_t previous = -1;
+    for (const auto &[doc_id, freq] : list.postings) {
+      totals[thread_id].first += std::bit_width(static_cast<uint64_t>(doc_id - previous));
+      previous = doc_id;
+    }
+    totals[thread_id].second += list.postings.size();
+  });
+
+  uint64_t bits = 0;
+  uint64_t num_gaps = 0;
+  for (const auto &[thread_bits, thread_gaps] : totals) {
+    bits += thread_bits;
+    num_gaps += thread_gaps;
+  }
+  return num_gaps == 0 ? 0.0 : static_cast<double>(bits) / static_cast<double>(num_gaps);
+}
+
+void InvertedIndexEngine::quantizeImpacts(const scoring::ScoringFunction &score_func) {
+  // The highest posting score determines the scale
+  std::vector<double> max_scores(NUM_THREADS, 0.0);
+  forEachPostingList([&](PostingList &list, size_t thread_id) {
+    uint32_t df = list.document_frequency;
+    for (const auto &[doc_id, freq] : list.postings) {
+      max_scores[thread_id] = std::max(
+          max_scores[thread_id], score_func.score({tokens_per_document_[doc_id]}, {freq, df}));
+    }
+  });
+  double max_score = *std::max_element(max_scores.begin(), max_scores.end());
+  impact_scale_ = max_score > 0.0 ? max_score / 255.0 : 1.0;
 
-    auto begin = doc.getData();
+  forEachPostingList([&](PostingList &list, size_t) {
+    uint32_t df = list.document_frequency;
+    list.impacts.resize(list.postings.size());
+    list.impact_ordered.clear();
+    list.impact_groups.clear();
+    for (size_t i = 0; i < list.postings.size(); ++i) {
+      const auto &[doc_id, freq] = list.postings[i];
+      double score = score_func.score({tokens_per_document_[doc_id]}, {freq, df});
+      long impact = std::lround(score / impact_scale_);
+      list.impacts[i] = static_cast<uint8_t>(std::clamp(impact, 0L, 255L));
+    }
+  });
+  impact_scorer_ = score_func.getName();
+  impact_ordered_ = false;
+  markIndexChanged();
+  impact_version_ = getIndexVersion();
+}
 
-    tokenizer::StemmingTokenizer tokenizer(begin, doc.getSize());
+void InvertedIndexEngine::orderByImpact(const scoring::ScoringFunction &score_func,
+                                        uint64_t posting_budget) {
+  quantizeImpacts(score_func);
 
-    for (auto token = tokenizer.nextToken(true); !token.empty();
-         token = tokenizer.nextToken(true)) {
-      local_term_frequency_per_document[token]++;
-      num_tokens++;
+  // A stable counting sort keeps the postings of an impact sorted by document id
+  forEachPostingList([](PostingList &list, size_t) {
+    std::array<uint32_t, 257> offsets{};
+    for (uint8_t impact : list.impacts) {
+      ++offsets[256 - impact];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    // Postings whose impact rounds to 0 add nothing to a score
+    for (int impact = 255; impact > 0; --impact) {
+      if (offsets[256 - impact] != offsets[255 - impact]) {
+        list.impact_groups.emplace_back(impact, offsets[256 - impact]);
+      }
     }
-    tokens_per_document_[doc.getId()] = num_tokens;
 
-    for (const auto &[token, freq] : local_term_frequency_per_document) {
-      auto add_term_frequency = [&doc, freq](std::vector<std::pair<DocumentID, uint32_t>> &docs) {
-        docs.emplace_back(doc.getId(), freq);
+    list.impact_ordered.resize(offsets[255]);
+    for (size_t i = 0; i < list.postings.size(); ++i) {
+      if (list.impacts[i] != 0) {
+        list.impact_ordered[offsets[255 - list.impacts[i]]++] = list.postings[i].first;
+      }
+    }
+  });
+  posting_budget_ = posting_budget;
+  impact_ordered_ = true;
+}
+
+void InvertedIndexEngine::computeMaxScores(const scoring::ScoringFunction &score_func) {
+  forEachPostingList([&](PostingList &list, size_t) {
+    uint32_t df = list.document_frequency;
+    list.max_score = 0.0;
+    for (const auto &[doc_id, freq] : list.postings) {
+      list.max_score =
+          std::max(list.max_score, score_func.score({tokens_per_document_[doc_id]}, {freq, df}));
+    }
+  });
+  max_score_scorer_ = score_func.getName();
+  max_score_version_ = getIndexVersion();
+}
+
+void InvertedIndexEngine::prune(const scoring::ScoringFunction &score_func, Pruning pruning,
+                                double keep_share, double max_df_share) {
+  // Also rejects NaN
+  if (!(keep_share > 0.0 && keep_share <= 1.0)) {
+    throw std::invalid_argument("The kept share of the postings must be in (0, 1]!");
+  }
+  if (!(max_df_share >= 0.0 && max_df_share <= 1.0)) {
+    throw std::invalid_argument("The maximum document frequency share must be in [0, 1]!");
+  }
+  auto max_df = static_cast<uint64_t>(max_df_share * static_cast<double>(getDocumentCount()));
+  auto num_kept = [keep_share](size_t num_postings) {
+    auto kept = static_cast<size_t>(std::ceil(keep_share * static_cast<double>(num_postings)));
+    return std::clamp<size_t>(kept, 1, num_postings);
+  };
+  auto score_of = [&](const PostingList &list, const std::pair<DocumentID, uint32_t> &posting) {
+    return score_func.score({tokens_per_document_[posting.first]},
+                            {posting.second, list.document_frequency});
+  };
+
+  // The score the kept postings of every document must reach
+  std::vector<float> min_doc_scores;
+  if (pruning == Pruning::DocumentCentric) {
+    std::vector<uint64_t> offsets(tokens_per_document_.size() + 1, 0);
+    for (const auto &list : posting_lists_) {
+      if (list.document_frequency <= max_df) {
+        for (const auto &[doc_id, freq] : list.postings) {
+          ++offsets[doc_id + 1];
+        }
+      }
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<float> doc_scores(offsets.back());
+    std::vector<uint64_t> positions(offsets.begin(), offsets.end() - 1);
+    for (const auto &list : posting_lists_) {
+      if (list.document_frequency <= max_df) {
+        for (const auto &posting : list.postings) {
+          doc_scores[positions[posting.first]++] = static_cast<float>(score_of(list, posting));
+        }
+      }
+    }
+
+    min_doc_scores.resize(tokens_per_document_.size());
+    for (size_t doc_id = 0; doc_id < min_doc_scores.size(); ++doc_id) {
+      auto begin = doc_scores.begin() + offsets[doc_id];
+      auto end = doc_scores.begin() + offsets[doc_id + 1];
+      if (begin != end) {
+        auto nth = begin + (num_kept(end - begin) - 1);
+        std::nth_element(begin, nth, end, std::greater<>());
+        min_doc_scores[doc_id] = *nth;
+      }
+    }
+  }
+
+  // The score the kept postings of every token must reach
+  std::vector<double> min_scores;
+  if (pruning == Pruning::TermCentric) {
+    min_scores.resize(posting_lists_.size());
+    parallelFor(posting_lists_.size(), [&](size_t index, size_t) {
+      const PostingList &list = posting_lists_[index];
+      size_t num_postings = list.postings.size();
+      if (list.document_frequency > max_df || num_postings == 0) {
+        return;
+      }
+      std::vector<double> scores;
+      scores.reserve(num_postings);
+      for (const auto &posting : list.postings) {
+        scores.push_back(score_of(list, posting));
+      }
+      auto nth = scores.begin() + (num_kept(num_postings) - 1);
+      std::nth_element(scores.begin(), nth, scores.end(), std::greater<>());
+      min_scores[index] = *nth;
+    });
+  }
+
+  pruning_statistics_ = {};
+  for (const auto &list : posting_lists_) {
+    pruning_statistics_.removed_terms += list.document_frequency > max_df && !list.postings.empty();
+  }
+  pruning_statistics_.removed_postings =
+      removePostings([&](uint32_t index, const Posting &posting) {
+        const PostingList &list = posting_lists_[index];
+        if (list.document_frequency > max_df) {
+          // Too frequent to tell documents apart, like a stop word
+          return true;
+        }
+        if (pruning == Pruning::TermCentric) {
+          return score_of(list, posting) < min_scores[index];
+        }
+        if (pruning == Pruning::DocumentCentric) {
+          return static_cast<float>(score_of(list, posting)) < min_doc_scores[posting.first];
+        }
+        return false;
+      });
+  pruning_statistics_.remaining_postings = packed_postings_.getPostingCount();
+  discardScoreData();
+}
+
+const InvertedIndexEngine::PruningStatistics &InvertedIndexEngine::getPruningStatistics() const {
+  return pruning_statistics_;
+}
+
+void InvertedIndexEngine::indexBatch(const std::vector<Document> &batch,
+                                     tokenizer::BatchTokenizer &tokenizer,
+                                     tokenizer::TokenBatch &tokens,
+                                     TermCounter &term_counter) {
+  tokenizer.tokenize(batch, tokens);
+
+  for (size_t doc_index = 0; doc_index < batch.size(); ++doc_index) {
+    const Document &doc = batch[doc_index];
+    uint32_t first_token = tokens.doc_offsets[doc_index];
+    uint32_t last_token = tokens.doc_offsets[doc_index + 1];
+
+    term_counter.clear();
+    for (uint32_t i = first_token; i < last_token; ++i) {
+      term_counter.add(tokens.token(i));
+    }
+    tokens_per_document_[doc.getId()] = last_token - first_token;
+
+    for (const auto &[token, freq] : term_counter) {
+      auto add_term_frequency = [&doc, freq, this](PostingList &docs) {
+        docs.added.push_back({doc.getId(), freq}, build_arena_);
+        ++docs.document_frequency;
       };
-      term_frequency_per_document_.updateOrInsert(token, add_term_frequency,
-                                                  std::vector<std::pair<DocumentID, uint32_t>>{});
+      term_frequency_per_document_.updateOrInsert(token, add_term_frequency, PostingList{});
     }
   }
 }
@@ -65,21 +632,25 @@ void InvertedIndexEngine::estimateDataStructureSizes(const std::string &data_pat
 
   std::atomic<uint32_t> max_doc_id = 0;
 
-  HyperLogLog<std::string> hyper_log_log{NUM_THREADS};
+  HyperLogLog<std::string_view> hyper_log_log{NUM_THREADS};
+  // Spilling builds collect their postings apart from the table, so it isn't sized
+  bool size_table = memory_budget_ == 0;
 
-  auto count_distinct_tokens = [&doc_it, &hyper_log_log, &max_doc_id](uint64_t thread_id) {
+  auto count_distinct_tokens = [&doc_it, &hyper_log_log, &max_doc_id, size_table,
+                                this](uint64_t thread_id) {
+    // Without the stem cache, so its hit rate only reflects the build
+    tokenizer::BatchTokenizer tokenizer(true, true, nullptr, unicode_);
+    tokenizer::TokenBatch tokens;
     std::vector<Document> current_batch = doc_it.next();
     uint32_t local_max_doc_id = 0;
     while (!current_batch.empty()) {
       for (Document &doc : current_batch) {
         local_max_doc_id = std::max(local_max_doc_id, doc.getId());
-        const auto begin = doc.getData();
-
-        tokenizer::StemmingTokenizer tokenizer(begin, doc.getSize());
-
-        for (auto token = tokenizer.nextToken(true); !token.empty();
-             token = tokenizer.nextToken(true)) {
-          hyper_log_log.add(token, thread_id);
+      }
+      if (size_table) {
+        tokenizer.tokenize(current_batch, tokens);
+        for (size_t i = 0; i < tokens.size(); ++i) {
+          hyper_log_log.add(tokens.token(i), thread_id);
         }
       }
       current_batch = doc_it.next();
@@ -100,65 +671,383 @@ void InvertedIndexEngine::estimateDataStructureSizes(const std::string &data_pat
     thread.join();
   }
 
-  term_frequency_per_document_ =
-      ParallelHashTable<std::string, std::vector<std::pair<DocumentID, uint32_t>>>{
-          hyper_log_log.getCount() * 2};
+  // The chains of the previous table are freed with it
+  term_frequency_per_document_ = ParallelHashTable<std::string, PostingList>{1};
+  table_arena_.release();
+  if (size_table) {
+    term_frequency_per_document_ =
+        ParallelHashTable<std::string, PostingList>{hyper_log_log.getCount() * 2, &table_arena_};
+  }
   tokens_per_document_.resize(max_doc_id + 1);
 }
 
 std::vector<std::pair<DocumentID, double>> InvertedIndexEngine::search(
     const std::string &query, const scoring::ScoringFunction &score_func, uint32_t num_results) {
   // Tokenize the query
-  tokenizer::StemmingTokenizer tokenizer(query.c_str(), query.size());
-  // tokenizer::SimpleTokenizer tokenizer(query.c_str(), query.size());
+  auto tokenizer = makeQueryTokenizer(query);
 
-  // Map of doc_id -> cumulative score
-  std::unordered_map<DocumentID, double> doc_to_score;
+  // Impacts and maximum scores only rank like the scoring function they were computed
+  // with, and only as long as the corpus statistics are unchanged, e.g. by deletions
+  uint64_t version = getIndexVersion();
+  std::string scorer_name = score_func.getName();
+  bool has_impacts = scorer_name == impact_scorer_ && impact_version_ == version;
+  bool has_max_scores = scorer_name == max_score_scorer_ && max_score_version_ == version;
+  Precision precision = precision_;
+  if (precision == Precision::Quantized && !has_impacts) {
+    precision = Precision::Double;
+  }
+  bool use_score_cache = score_cache_ && precision != Precision::Quantized &&
+                         !(impact_ordered_ && has_impacts);
+  // Scoring functions of the same name score differently once the corpus changed, so
+  // the cached scores are keyed by the index version and the older ones are dropped
+  if (use_score_cache) {
+    uint64_t cached_version = score_cache_version_.load();
+    if (cached_version != version &&
+        score_cache_version_.compare_exchange_strong(cached_version, version)) {
+      score_cache_->clear();
+    }
+  }
 
-  // Compute scores for each token in the query
-  for (auto token = tokenizer.nextToken(true); !token.empty();
-       token = tokenizer.nextToken(true)) {
-    auto it = term_frequency_per_document_.find(token);
-    if (it == term_frequency_per_document_.end()) {
+  // The posting lists of the query's tokens and the cached scores of the hot ones
+  thread_local std::vector<QueryTerm> postings;
+  postings.clear();
+  uint64_t num_postings = 0;
+  std::string key_suffix =
+      use_score_cache ? std::string(1, '\0') + scorer_name + '\0' + std::to_string(version)
+                      : std::string{};
+  for (auto token = tokenizer->nextToken(true); !token.empty();
+       token = tokenizer->nextToken(true)) {
+    uint32_t index = packed_postings_.find(token);
+    if (index == packed_postings_.kNotFound) {
       // This token doesn't appear in any document
       continue;
     }
+    const PostingList &list = posting_lists_[index];
+    num_postings += list.postings.size();
+    if (!use_score_cache || list.postings.size() < kMinCachedPostings) {
+      postings.push_back({&list, nullptr});
+      continue;
+    }
 
-    std::vector<std::pair<DocumentID, uint32_t>> appearances = it->second;
+    std::string key = token + key_suffix;
+    auto scores = score_cache_->lookup(key);
+    if (!scores && score_cache_->admits(key, list.postings.size())) {
+      scores = scorePostings(list, score_func);
+      score_cache_->insert(key, scores);
+    }
+    postings.push_back({&list, std::move(scores)});
+  }
+
+  std::vector<std::pair<DocumentID, double>> results;
+  if (impact_ordered_ && has_impacts) {
+    results = rankByImpact(postings, num_results);
+  } else if (precision == Precision::Double && has_max_scores) {
+    results = rankMaxScore(postings, score_func, num_results);
+  } else if (precision == Precision::Float) {
+    results = rank<float>(postings, num_postings, score_func, num_results);
+  } else if (precision == Precision::Quantized) {
+    results = rank<uint32_t>(postings, num_postings, score_func, num_results);
+  } else {
+    results = rank<double>(postings, num_postings, score_func, num_results);
+  }
 
-    // For each document that contains this token, accumulate its score
-    for (const auto &[doc_id, freq] : appearances) {
-      double score = score_func.score({tokens_per_document_[doc_id]},
-                                      {freq, static_cast<uint32_t>(appearances.size())});
-      doc_to_score[doc_id] += score;
+  // Report the ids the documents were indexed with
+  if (!original_ids_.empty()) {
+    for (auto &[doc_id, score] : results) {
+      doc_id = original_ids_[doc_id];
     }
   }
+  return results;
+}
+
+template <typename Score>
+std::vector<std::pair<DocumentID, double>> InvertedIndexEngine::rank(
+    const std::vector<QueryTerm> &postings, uint64_t num_postings,
+    const scoring::ScoringFunction &score_func, uint32_t num_results) {
+  // Track the top documents by score
+  TopK results(num_results);
+  auto num_doc_ids = static_cast<DocumentID>(tokens_per_document_.size());
 
-  // Use a min-heap to track the top 10 documents by score
-  std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>,
-                      std::greater<>>
-      results;
+  if (query_threads_ <= 1 || num_postings < kMinParallelPostings) {
+    scoreRange<Score>(postings, 0, num_doc_ids, score_func, results);
+  } else {
+    // Split the doc ids into ranges holding equally many postings of the longest list
+    std::span<const Posting> longest =
+        std::max_element(postings.begin(), postings.end(), [](const auto &lhs, const auto &rhs) {
+          return lhs.list->postings.size() < rhs.list->postings.size();
+        })->list->postings;
+    std::vector<DocumentID> bounds(query_threads_ + 1, num_doc_ids);
+    bounds[0] = 0;
+    for (size_t i = 1; i < query_threads_; ++i) {
+      bounds[i] = longest[i * longest.size() / query_threads_].first;
+    }
 
-  for (const auto &entry : doc_to_score) {
-    const double &score = entry.second;
-    const uint32_t &doc_id = entry.first;
+    // Every range is scored into its own top-k heap by the shared workers, which are
+    // busy with other queries of a batch at times, so the ranges are claimed dynamically
+    std::vector<TopK> range_results(query_threads_, TopK(num_results));
+    queries::WorkerPool::shared().run(query_threads_, query_threads_, [&](size_t i) {
+      scoreRange<Score>(postings, bounds[i], bounds[i + 1], score_func, range_results[i]);
+    });
 
-    if (results.size() < num_results) {
-      results.emplace(score, doc_id);
-    } else if (score > results.top().first) {
-      results.pop();
-      results.emplace(score, doc_id);
+    // The overall top-k are among the top-k of the ranges
+    for (const auto &range_top : range_results) {
+      results.merge(range_top);
     }
   }
 
   // Extract top documents in descending order of score
-  std::vector<std::pair<DocumentID, double>> top_documents{results.size()};
-  for (int i = static_cast<int>(results.size()) - 1; i >= 0; i--) {
-    top_documents[i] = {static_cast<uint32_t>(results.top().second), results.top().first};
-    results.pop();
+  return results.extract();
+}
+
+template <typename Score>
+void InvertedIndexEngine::scoreRange(const std::vector<QueryTerm> &postings,
+                                     DocumentID first_doc, DocumentID last_doc,
+                                     const scoring::ScoringFunction &score_func,
+                                     TopK &results) const {
+  auto by_doc_id = [](const std::pair<DocumentID, uint32_t> &posting, DocumentID doc_id) {
+    return posting.first < doc_id;
+  };
+
+  // Accumulate into one Score per document, remembering which ones to reset, so
+  // narrower scores move less memory. Scores may be 0 or cancel out, so whether a
+  // document was touched is kept apart from its score
+  thread_local std::vector<Score> accumulators;
+  thread_local std::vector<bool> is_touched;
+  thread_local std::vector<DocumentID> touched;
+  accumulators.resize(tokens_per_document_.size());
+  is_touched.resize(tokens_per_document_.size());
+  touched.clear();
+  auto accumulate = [](DocumentID doc_id, Score score) {
+    if (!is_touched[doc_id]) {
+      is_touched[doc_id] = true;
+      touched.push_back(doc_id);
+    }
+    accumulators[doc_id] += score;
+  };
+
+  // Compute scores for each token in the query
+  for (const auto &[list, scores] : postings) {
+    std::span<const Posting> appearances = list->postings;
+    auto begin = std::lower_bound(appearances.begin(), appearances.end(), first_doc, by_doc_id);
+    auto end = std::lower_bound(begin, appearances.end(), last_doc, by_doc_id);
+
+    if constexpr (std::is_integral_v<Score>) {
+      // The impacts are precomputed, postings whose impact rounds to 0 add nothing
+      for (auto it = begin; it != end; ++it) {
+        uint8_t impact = list->impacts[it - appearances.begin()];
+        if (impact != 0) {
+          accumulate(it->first, impact);
+        }
+      }
+    } else if (scores) {
+      // The scores of hot tokens are cached
+      for (auto it = begin; it != end; ++it) {
+        accumulate(it->first, static_cast<Score>((*scores)[it - appearances.begin()]));
+      }
+    } else {
+      // For each document of the range that contains this token, accumulate its score
+      for (auto it = begin; it != end; ++it) {
+        const auto &[doc_id, freq] = *it;
+        double score =
+            score_func.score({tokens_per_document_[doc_id]}, {freq, list->document_frequency});
+        accumulate(doc_id, static_cast<Score>(score));
+      }
+    }
+  }
+
+  for (DocumentID doc_id : touched) {
+    if (!deleted_.contains(doc_id)) {
+      if constexpr (std::is_integral_v<Score>) {
+        results.push(static_cast<double>(accumulators[doc_id]) * impact_scale_, doc_id);
+      } else {
+        results.push(accumulators[doc_id], doc_id);
+      }
+    }
+    accumulators[doc_id] = 0;
+    is_touched[doc_id] = false;
+  }
+}
+
+std::vector<std::pair<DocumentID, double>> InvertedIndexEngine::rankByImpact(
+    const std::vector<QueryTerm> &postings, uint32_t num_results) const {
+  // The impact groups of all tokens, highest impact first
+  struct Group {
+    uint8_t impact;
+    const DocumentID *begin;
+    const DocumentID *end;
+  };
+  thread_local std::vector<Group> groups;
+  groups.clear();
+  for (const auto &term : postings) {
+    const PostingList &list = *term.list;
+    uint32_t begin = 0;
+    for (const auto &[impact, end] : list.impact_groups) {
+      groups.push_back({impact, list.impact_ordered.data() + begin,
+                        list.impact_ordered.data() + end});
+      begin = end;
+    }
+  }
+  std::stable_sort(groups.begin(), groups.end(),
+                   [](const Group &lhs, const Group &rhs) { return lhs.impact > rhs.impact; });
+
+  // Accumulate into one counter per document, remembering which ones to reset
+  thread_local std::vector<uint32_t> accumulators;
+  thread_local std::vector<DocumentID> touched;
+  accumulators.resize(tokens_per_document_.size());
+  touched.clear();
+  uint64_t budget = posting_budget_ == 0 ? std::numeric_limits<uint64_t>::max() : posting_budget_;
+  for (const auto &[impact, begin, end] : groups) {
+    if (budget == 0) {
+      break;
+    }
+    auto count = static_cast<uint64_t>(end - begin);
+    const DocumentID *stop = begin + std::min(count, budget);
+    budget -= stop - begin;
+    for (const DocumentID *doc_id = begin; doc_id != stop; ++doc_id) {
+      if (accumulators[*doc_id] == 0) {
+        touched.push_back(*doc_id);
+      }
+      accumulators[*doc_id] += impact;
+    }
   }
 
-  return top_documents;
+  TopK results(num_results);
+  for (DocumentID doc_id : touched) {
+    if (!deleted_.contains(doc_id)) {
+      results.push(static_cast<double>(accumulators[doc_id]) * impact_scale_, doc_id);
+    }
+    accumulators[doc_id] = 0;
+  }
+  return results.extract();
+}
+
+std::vector<std::pair<DocumentID, double>> InvertedIndexEngine::rankMaxScore(
+    const std::vector<QueryTerm> &postings, const scoring::ScoringFunction &score_func,
+    uint32_t num_results) const {
+  // A cursor into every posting list, by ascending upper bound
+  struct Cursor {
+    const QueryTerm *term;
+    size_t position;
+  };
+  thread_local std::vector<Cursor> cursors;
+  cursors.clear();
+  for (const auto &term : postings) {
+    cursors.push_back({&term, 0});
+  }
+  std::sort(cursors.begin(), cursors.end(), [](const Cursor &lhs, const Cursor &rhs) {
+    return lhs.term->list->max_score < rhs.term->list->max_score;
+  });
+
+  // bounds[i] is the highest score a document can get from the lists 0..i
+  thread_local std::vector<double> bounds;
+  bounds.clear();
+  double bound = 0.0;
+  for (const auto &cursor : cursors) {
+    bound += cursor.term->list->max_score;
+    bounds.push_back(bound);
+  }
+
+  auto score_at = [&](const Cursor &cursor) {
+    const auto &[list, scores] = *cursor.term;
+    if (scores) {
+      return (*scores)[cursor.position];
+    }
+    const auto &[doc_id, freq] = list->postings[cursor.position];
+    return score_func.score({tokens_per_document_[doc_id]}, {freq, list->document_frequency});
+  };
+  auto by_doc_id = [](const std::pair<DocumentID, uint32_t> &posting, DocumentID doc_id) {
+    return posting.first < doc_id;
+  };
+
+  // Documents only in the lists before first_essential can't enter the top-k
+  TopK results(num_results);
+  size_t first_essential = 0;
+  while (first_essential < cursors.size()) {
+    // The next candidate is the smallest document id of the essential lists
+    DocumentID candidate = std::numeric_limits<DocumentID>::max();
+    for (size_t i = first_essential; i < cursors.size(); ++i) {
+      std::span<const Posting> appearances = cursors[i].term->list->postings;
+      if (cursors[i].position < appearances.size()) {
+        candidate = std::min(candidate, appearances[cursors[i].position].first);
+      }
+    }
+    if (candidate == std::numeric_limits<DocumentID>::max()) {
+      break;
+    }
+
+    bool deleted = deleted_.contains(candidate);
+    double score = 0.0;
+    for (size_t i = first_essential; i < cursors.size(); ++i) {
+      Cursor &cursor = cursors[i];
+      std::span<const Posting> appearances = cursor.term->list->postings;
+      if (cursor.position < appearances.size() &&
+          appearances[cursor.position].first == candidate) {
+        score += deleted ? 0.0 : score_at(cursor);
+        ++cursor.position;
+      }
+    }
+    if (deleted) {
+      continue;
+    }
+
+    // Probe the non-essential lists while the candidate can still enter the top-k
+    bool pruned = false;
+    for (size_t i = first_essential; i-- > 0;) {
+      if (score + bounds[i] <= results.threshold()) {
+        pruned = true;
+        break;
+      }
+      Cursor &cursor = cursors[i];
+      std::span<const Posting> appearances = cursor.term->list->postings;
+      cursor.position = std::lower_bound(appearances.begin() + cursor.position,
+                                         appearances.end(), candidate, by_doc_id) -
+                        appearances.begin();
+      if (cursor.position < appearances.size() &&
+          appearances[cursor.position].first == candidate) {
+        score += score_at(cursor);
+      }
+    }
+    if (pruned) {
+      continue;
+    }
+
+    results.push(score, candidate);
+    while (first_essential < cursors.size() && bounds[first_essential] <= results.threshold()) {
+      ++first_essential;
+    }
+  }
+  return results.extract();
+}
+
+std::shared_ptr<const ScoreCache::Scores> InvertedIndexEngine::scorePostings(
+    const PostingList &list, const scoring::ScoringFunction &score_func) const {
+  auto scores = std::make_shared<ScoreCache::Scores>();
+  scores->reserve(list.postings.size());
+  for (const auto &[doc_id, freq] : list.postings) {
+    scores->push_back(
+        score_func.score({tokens_per_document_[doc_id]}, {freq, list.document_frequency}));
+  }
+  return scores;
+}
+
+std::string InvertedIndexEngine::normalizeQuery(const std::string &query) {
+  std::string normalized;
+  auto tokenizer = makeQueryTokenizer(query);
+  for (auto token = tokenizer->nextToken(true); !token.empty();
+       token = tokenizer->nextToken(true)) {
+    normalized.append(token).push_back(' ');
+  }
+  return normalized;
+}
+
+std::unique_ptr<tokenizer::ITokenizer> InvertedIndexEngine::makeQueryTokenizer(
+    const std::string &query) const {
+  if (unicode_) {
+    return std::make_unique<tokenizer::Utf8Tokenizer>(query.c_str(), query.size(), true,
+                                                      stem_cache_.get());
+  }
+  return std::make_unique<tokenizer::StemmingTokenizer>(query.c_str(), query.size(),
+                                                        stem_cache_.get());
 }
 
 uint64_t InvertedIndexEngine::footprint_capacity() {
@@ -166,11 +1055,14 @@ uint64_t InvertedIndexEngine::footprint_capacity() {
   size_t tokens_per_document_footprint =
       tokens_per_document_.capacity() * sizeof(tokens_per_document_type);
 
-  size_t token_frequency_map_footprint = term_frequency_per_document_.footprint_capacity();
-  for (auto &[key, value] : term_frequency_per_document_) {
-    token_frequency_map_footprint += (value.capacity() * sizeof(std::pair<uint32_t, uint32_t>));
+  size_t posting_lists_footprint =
+      packed_postings_.footprint_capacity() + posting_lists_.capacity() * sizeof(PostingList);
+  for (const auto &list : posting_lists_) {
+    posting_lists_footprint += list.impacts.capacity() * sizeof(uint8_t) +
+                               list.impact_ordered.capacity() * sizeof(DocumentID) +
+                               list.impact_groups.capacity() * sizeof(std::pair<uint8_t, uint32_t>);
   }
-  return token_frequency_map_footprint + tokens_per_document_footprint +
+  return posting_lists_footprint + tokens_per_document_footprint + deleted_.footprint() +
          sizeof(InvertedIndexEngine);
 }
 
@@ -179,26 +1071,30 @@ uint64_t InvertedIndexEngine::footprint_size() {
   size_t tokens_per_document_footprint =
       tokens_per_document_.size() * sizeof(tokens_per_document_type);
 
-  size_t token_frequency_map_footprint = term_frequency_per_document_.footprint_size();
-  for (auto &[key, value] : term_frequency_per_document_) {
-    token_frequency_map_footprint += (value.size() * sizeof(std::pair<uint32_t, uint32_t>));
+  size_t posting_lists_footprint =
+      packed_postings_.footprint_size() + posting_lists_.size() * sizeof(PostingList);
+  for (const auto &list : posting_lists_) {
+    posting_lists_footprint += list.impacts.size() * sizeof(uint8_t) +
+                               list.impact_ordered.size() * sizeof(DocumentID) +
+                               list.impact_groups.size() * sizeof(std::pair<uint8_t, uint32_t>);
   }
-  return token_frequency_map_footprint + tokens_per_document_footprint +
+  return posting_lists_footprint + tokens_per_document_footprint + deleted_.footprint() +
          sizeof(InvertedIndexEngine);
 }
 
-uint32_t InvertedIndexEngine::getDocumentCount() { return tokens_per_document_.size(); }
+const tokenizer::StemCache *InvertedIndexEngine::getStemCache() const { return stem_cache_.get(); }
+
+ScoreCache *InvertedIndexEngine::getScoreCache() const { return score_cache_.get(); }
+
+uint32_t InvertedIndexEngine::getDocumentCount() {
+  return tokens_per_document_.size() - deleted_.count();
+}
 
 double InvertedIndexEngine::getAvgDocumentLength() {
-  if (average_doc_length_ != -1) {
-    return average_doc_length_;
-  }
-  average_doc_length_ =
-      tokens_per_document_.empty()
-          ? 0.0
-          : static_cast<double>(
-                std::accumulate(tokens_per_document_.begin(), tokens_per_document_.end(), 0ull,
-                                [](uint32_t sum, const uint32_t &entry) { return sum + entry; })) /
-                static_cast<double>(tokens_per_document_.size());
-  return average_doc_length_;
+  // Nothing is cached here, searches call this while documents are deleted
+  uint32_t num_documents = getDocumentCount();
+  if (num_documents == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(num_tokens_ - deleted_tokens_) / static_cast<double>(num_documents);
 }
\ No newline at end of file
@@ -5,16 +5,71 @@
 #ifndef INVERTED_INDEX_ENGINE_HPP
 #define INVERTED_INDEX_ENGINE_HPP
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
 #include <thread>
 
+#include "data-structures/arena.hpp"
+#include "data-structures/chunked_list.hpp"
+#include "data-structures/packed_postings.hpp"
 #include "data-structures/parallel_hash_table.hpp"
+#include "data-structures/sorted_runs.hpp"
+#include "data-structures/term_counter.hpp"
+#include "data-structures/tombstones.hpp"
+#include "data-structures/top_k.hpp"
 #include "documents/document_iterator.hpp"
 #include "fts_engine.hpp"
+#include "score_cache.hpp"
+#include "tokenizer/ITokenizer.hpp"
+#include "tokenizer/batch_tokenizer.hpp"
+#include "tokenizer/stem_cache.hpp"
 
 struct Token;
 
 class InvertedIndexEngine : public FullTextSearchEngine {
  public:
+  /// The arithmetic of the score accumulation.
+  enum class Precision : uint8_t {
+    /// exact scores summed in double
+    Double,
+    /// exact scores rounded to and summed in float
+    Float,
+    /// 8-bit impacts precomputed by quantizeImpacts, summed as integers
+    Quantized
+  };
+
+  /// How prune selects the postings to keep.
+  enum class Pruning : uint8_t {
+    /// keep all postings of the tokens that aren't too frequent
+    None,
+    /// keep the best scoring share of the postings of every token
+    TermCentric,
+    /// keep the best scoring share of the postings of every document
+    DocumentCentric
+  };
+
+  /// What prune removed.
+  struct PruningStatistics {
+    /// number of tokens whose postings were dropped for appearing in too many documents
+    uint64_t removed_terms = 0;
+    /// number of postings removed
+    uint64_t removed_postings = 0;
+    /// number of postings left
+    uint64_t remaining_postings = 0;
+  };
+
+  /// Constructor. Memoizes stems of frequent surface forms if use_stem_cache is set.
+  /// Keeps and case-folds non-ASCII letters if unicode is set. Scores queries with many
+  /// postings on up to query_threads threads of the shared queries::WorkerPool. Caches
+  /// the posting scores of hot terms in up to score_cache_bytes, 0 disables the cache.
+  /// Renumbers similar documents consecutively after indexing if reorder_documents is set.
+  explicit InvertedIndexEngine(bool use_stem_cache = true, bool unicode = false,
+                               uint32_t query_threads = 1, uint64_t score_cache_bytes = 0,
+                               Precision precision = Precision::Double,
+                               bool reorder_documents = false);
+
   void indexDocuments(std::string &data_path) override;
 
   std::vector<std::pair<DocumentID, double>> search(const std::string &query,
@@ -28,21 +83,287 @@ class InvertedIndexEngine : public FullTextSearchEngine {
 
   double getAvgDocumentLength() override;
 
+  /// Returns the stemmed query tokens without stop words.
+  std::string normalizeQuery(const std::string &query) override;
+
+  /// Get the stem cache, nullptr if disabled.
+  [[nodiscard]] const tokenizer::StemCache *getStemCache() const;
+
+  /// Get the posting score cache, nullptr if disabled.
+  [[nodiscard]] ScoreCache *getScoreCache() const;
+
+  /**
+   * Precomputes the quantized impact of every posting for Precision::Quantized.
+   *
+   * The highest posting score maps to 255, all others are rounded linearly. Queries
+   * scored by another scoring function than score_func fall back to Precision::Double.
+   */
+  void quantizeImpacts(const scoring::ScoringFunction &score_func);
+
+  /**
+   * Groups the postings of every token by descending quantized impact and answers
+   * queries scored by score_func score-at-a-time from these groups.
+   *
+   * The groups of all query tokens are processed from the highest impact down, so
+   * stopping early drops the smallest contributions first. A query stops after
+   * posting_budget postings, 0 processes all of them and ranks like
+   * Precision::Quantized.
+   */
+  void orderByImpact(const scoring::ScoringFunction &score_func, uint64_t posting_budget = 0);
+
+  /**
+   * Precomputes the highest posting score of every token and answers queries scored by
+   * score_func with MaxScore.
+   *
+   * Tokens whose summed upper bounds can't reach the current top-k threshold are only
+   * probed for the candidates of the others. Ranks like the exhaustive evaluation but on
+   * the calling thread only, and only with Precision::Double.
+   */
+  void computeMaxScores(const scoring::ScoringFunction &score_func);
+
+  /**
+   * Statically prunes the index for queries scored by score_func.
+   *
+   * Drops all postings of tokens appearing in more than max_df_share of the documents.
+   * Of the other tokens, keeps the keep_share best scoring postings of every token or
+   * document as chosen by pruning, at least one. Document frequencies are kept, so the
+   * remaining postings score as before. Discards the impacts and maximum scores. Throws
+   * std::invalid_argument unless keep_share is in (0, 1] and max_df_share in [0, 1].
+   */
+  void prune(const scoring::ScoringFunction &score_func, Pruning pruning, double keep_share,
+             double max_df_share = 1.0);
+
+  /// Get what the last prune removed.
+  [[nodiscard]] const PruningStatistics &getPruningStatistics() const;
+
+  /// Deletes a document, false if it isn't indexed, has no tokens or is already deleted.
+  /// Queries skip it right away, its postings stay until compact. The impacts and maximum
+  /// scores are stale afterwards. May run concurrently with search.
+  bool deleteDocument(DocumentID doc_id);
+
+  /**
+   * Replaces the indexed versions of the documents of a Parquet file or directory and
+   * adds the new ones.
+   *
+   * The old versions are deleted and compacted before the new ones are indexed, which
+   * rewrites every posting list, so updates should be batched. Not supported for
+   * renumbered documents.
+   */
+  void updateDocuments(const std::string &data_path);
+
+  /// Removes the postings of deleted documents. Discards the impacts and maximum scores.
+  void compact();
+
+  /**
+   * Bounds the memory of the posting lists built by the next indexDocuments.
+   *
+   * Once the postings collected by the threads exceed about budget_bytes, they are
+   * written as sorted runs to a directory below spill_directory. The runs are merged
+   * into exactly sized posting lists at the end, so the build needs the final index
+   * plus the budget instead of the growing posting lists. 0 builds in memory.
+   */
+  void setMemoryBudget(uint64_t budget_bytes, const std::string &spill_directory);
+
+  /// Get what the last indexDocuments spilled to disk.
+  [[nodiscard]] const SpillStatistics &getSpillStatistics() const;
+
+  /// Get the mean number of bits of the document id gaps in the posting lists, the size
+  /// of a gap encoded in its minimal binary length.
+  [[nodiscard]] double getAverageGapBits();
+
  private:
+  using Posting = std::pair<DocumentID, uint32_t>;
+  using Postings = std::vector<Posting>;
+
+  /// The postings of a token.
+  struct PostingList {
+    /// document id and term frequency of every posting, sorted by document id, the
+    /// token's range of packed_postings_
+    std::span<Posting> postings;
+    /// postings added by the running build in build_arena_, packed by finalize
+    ChunkedList<Posting> added;
+    /// number of documents containing the token, kept when postings are pruned
+    uint32_t document_frequency = 0;
+    /// quantized score of every posting, empty until quantizeImpacts
+    std::vector<uint8_t> impacts;
+    /// document ids by descending impact, by document id within an impact, empty until
+    /// orderByImpact
+    std::vector<DocumentID> impact_ordered;
+    /// impact and end offset in impact_ordered of every group, by descending impact
+    std::vector<std::pair<uint8_t, uint32_t>> impact_groups;
+    /// highest score of a posting but at least 0, set by computeMaxScores
+    double max_score = 0.0;
+  };
+
+  /// A posting list of a query and its cached scores, if any.
+  struct QueryTerm {
+    const PostingList *list;
+    std::shared_ptr<const ScoreCache::Scores> scores;
+  };
+
+  /// Queries with fewer postings are scored on the calling thread only.
+  static constexpr uint64_t kMinParallelPostings = 1 << 15;
+
+  /// Shorter posting lists are scored directly, they aren't worth a cache lookup.
+  static constexpr size_t kMinCachedPostings = 256;
+
   void estimateDataStructureSizes(const std::string &data_path);
 
-  void indexBatch(const std::vector<Document> &batch);
+  /// Indexes the documents of doc_it on all threads, appending to the posting lists.
+  void indexAll(DocumentIterator &doc_it);
+
+  /// Indexes the documents of doc_it on all threads within memory_budget_, spilling
+  /// sorted runs to disk and merging them into the posting lists at the end.
+  void indexSpilling(DocumentIterator &doc_it);
+
+  /// Forgets everything derived from the posting lists and scoring functions.
+  void discardScoreData();
+
+  /// Scores every posting of a token.
+  std::shared_ptr<const ScoreCache::Scores> scorePostings(
+      const PostingList &list, const scoring::ScoringFunction &score_func) const;
+
+  /// Creates the tokenizer splitting a query like the indexed documents.
+  std::unique_ptr<tokenizer::ITokenizer> makeQueryTokenizer(const std::string &query) const;
+
+  /// Calls fn(index, thread_id) for every index in [0, count), spread over all threads.
+  void parallelFor(size_t count, const std::function<void(size_t, size_t)> &fn);
+
+  /// Calls fn(list, thread_id) for every posting list, spread over all threads.
+  void forEachPostingList(const std::function<void(PostingList &, size_t)> &fn);
+
+  /**
+   * Packs the posting lists and the postings added by a build into packed_postings_,
+   * sorted by document id, and frees the table and arenas of the build.
+   *
+   * A token's postings end up in one contiguous range of a cache line aligned buffer,
+   * so a query reads them without following a chain of chunks or a vector per list.
+   */
+  void finalize();
+
+  /// Removes the postings for which remove(index, posting) holds from the posting lists
+  /// of packed_postings_, the index being the list's. Discards the impacts and maximum
+  /// scores. Get the number of removed postings.
+  uint64_t removePostings(const std::function<bool(uint32_t, const Posting &)> &remove);
+
+  /// Renumbers the documents by their MinHash signatures, so documents sharing many tokens
+  /// get close ids.
+  void reorderDocuments();
+
+  /// Selects the best documents for the query's posting lists, accumulating Score.
+  template <typename Score>
+  std::vector<std::pair<DocumentID, double>> rank(const std::vector<QueryTerm> &postings,
+                                                  uint64_t num_postings,
+                                                  const scoring::ScoringFunction &score_func,
+                                                  uint32_t num_results);
+
+  /// Scores the documents in [first_doc, last_doc) into a dense array of Score and
+  /// offers them to results.
+  template <typename Score>
+  void scoreRange(const std::vector<QueryTerm> &postings, DocumentID first_doc,
+                  DocumentID last_doc, const scoring::ScoringFunction &score_func,
+                  TopK &results) const;
+
+  /// Selects the best documents score-at-a-time from the impact-ordered posting lists.
+  std::vector<std::pair<DocumentID, double>> rankByImpact(
+      const std::vector<QueryTerm> &postings, uint32_t num_results) const;
+
+  /// Selects the best documents with MaxScore from the document id ordered posting lists.
+  std::vector<std::pair<DocumentID, double>> rankMaxScore(
+      const std::vector<QueryTerm> &postings, const scoring::ScoringFunction &score_func,
+      uint32_t num_results) const;
+
+  void indexBatch(const std::vector<Document> &batch, tokenizer::BatchTokenizer &tokenizer,
+                  tokenizer::TokenBatch &tokens, TermCounter &term_counter);
 
   const uint64_t NUM_THREADS = std::thread::hardware_concurrency();
 
-  double average_doc_length_ = -1.0;
+  /// number of tokens of all documents, the deleted ones included
+  uint64_t num_tokens_ = 0;
+
+  /// the deleted documents
+  Tombstones deleted_;
+
+  /// number of tokens of the deleted documents
+  std::atomic<uint64_t> deleted_tokens_ = 0;
+
+  /// the bucket chains of term_frequency_per_document_, declared first to outlive them
+  Arena table_arena_;
 
-  /// key is token, value is a map of doc id to term frequency
-  ParallelHashTable<std::string, std::vector<std::pair<DocumentID, uint32_t>>>
-      term_frequency_per_document_{1};
+  /// the postings added by a running build
+  Arena build_arena_;
+
+  /// key is token, value is the posting list it gets in a running build, empty otherwise
+  ParallelHashTable<std::string, PostingList> term_frequency_per_document_{1};
+
+  /// the postings of every token back to back, list i belongs to posting_lists_[i]
+  PackedPostings<std::string, Posting> packed_postings_;
+
+  /// the posting list of every token of packed_postings_, by index
+  std::vector<PostingList> posting_lists_;
 
   /// key is document id, value is number of tokens or terms
   std::vector<uint32_t> tokens_per_document_;
+
+  /// memoized stems shared by all tokenizers of this engine, nullptr if disabled
+  std::unique_ptr<tokenizer::StemCache> stem_cache_;
+
+  /// whether documents and queries are tokenized as UTF-8
+  bool unicode_;
+
+  /// maximum number of threads scoring one query
+  uint32_t query_threads_;
+
+  /// the scores of the postings of hot terms, nullptr if disabled
+  std::unique_ptr<ScoreCache> score_cache_;
+
+  /// the index version of the scores in score_cache_
+  std::atomic<uint64_t> score_cache_version_ = 0;
+
+  /// the arithmetic of the score accumulation
+  Precision precision_;
+
+  /// the score of impact 1, i.e. the highest posting score / 255
+  double impact_scale_ = 0.0;
+
+  /// the name of the scoring function the impacts were computed with, empty if none
+  std::string impact_scorer_;
+
+  /// the index version the impacts were computed for
+  uint64_t impact_version_ = 0;
+
+  /// whether queries are answered from the impact-ordered posting lists
+  bool impact_ordered_ = false;
+
+  /// maximum number of postings processed score-at-a-time per query, 0 for all
+  uint64_t posting_budget_ = 0;
+
+  /// the name of the scoring function the maximum scores were computed with, empty if none
+  std::string max_score_scorer_;
+
+  /// the index version the maximum scores were computed for
+  uint64_t max_score_version_ = 0;
+
+  /// what the last prune removed
+  PruningStatistics pruning_statistics_;
+
+  /// maximum number of bytes of postings collected before spilling, 0 for no limit
+  uint64_t memory_budget_ = 0;
+
+  /// the directory below which the runs are spilled
+  std::string spill_directory_;
+
+  /// what the last indexDocuments spilled to disk
+  SpillStatistics spill_statistics_;
+
+  /// whether the documents are renumbered after indexing
+  bool reorder_documents_;
+
+  /// key is internal document id, value is the original one, empty if not renumbered
+  std::vector<DocumentID> original_ids_;
+
+  /// key is original document id, value is the internal one, empty if not renumbered
+  std::vector<DocumentID> internal_ids_;
 };
 
 #endif  // INVERTED_INDEX_ENGINE_HPP
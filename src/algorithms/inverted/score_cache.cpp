@@ -0,0 +1,108 @@
+#include "score_cache.hpp"
+
+ScoreCache::ScoreCache(uint64_t capacity_bytes) : capacity_bytes_(capacity_bytes) {}
+
+std::shared_ptr<const ScoreCache::Scores> ScoreCache::lookup(const std::string &key) {
+  std::lock_guard lock(mutex_);
+  sketch_.add(key);
+  auto it = positions_.find(key);
+  if (it == positions_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->scores;
+}
+
+bool ScoreCache::admits(const std::string &key, size_t num_scores) {
+  std::lock_guard lock(mutex_);
+  if (admitsLocked(key, entryBytes(key, num_scores))) return true;
+  ++rejections_;
+  return false;
+}
+
+void ScoreCache::insert(const std::string &key, std::shared_ptr<const Scores> scores) {
+  uint64_t bytes = entryBytes(key, scores->size());
+  std::lock_guard lock(mutex_);
+  if (positions_.contains(key)) return;
+  if (!admitsLocked(key, bytes)) {
+    ++rejections_;
+    return;
+  }
+  while (size_bytes_ + bytes > capacity_bytes_) evict();
+
+  entries_.push_front({key, std::move(scores), bytes});
+  positions_.emplace(entries_.front().key, entries_.begin());
+  size_bytes_ += bytes;
+  ++admissions_;
+}
+
+void ScoreCache::clear() {
+  std::lock_guard lock(mutex_);
+  positions_.clear();
+  entries_.clear();
+  size_bytes_ = 0;
+}
+
+uint64_t ScoreCache::getHits() {
+  std::lock_guard lock(mutex_);
+  return hits_;
+}
+
+uint64_t ScoreCache::getMisses() {
+  std::lock_guard lock(mutex_);
+  return misses_;
+}
+
+double ScoreCache::getHitRate() {
+  std::lock_guard lock(mutex_);
+  return hits_ + misses_ == 0 ? 0.0
+                              : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+}
+
+uint64_t ScoreCache::getAdmissions() {
+  std::lock_guard lock(mutex_);
+  return admissions_;
+}
+
+uint64_t ScoreCache::getRejections() {
+  std::lock_guard lock(mutex_);
+  return rejections_;
+}
+
+uint64_t ScoreCache::getEvictions() {
+  std::lock_guard lock(mutex_);
+  return evictions_;
+}
+
+uint64_t ScoreCache::getSizeBytes() {
+  std::lock_guard lock(mutex_);
+  return size_bytes_;
+}
+
+uint64_t ScoreCache::entryBytes(const std::string &key, size_t num_scores) {
+  // The entry, its list links, its hash map node and the score array
+  return sizeof(Entry) + 2 * sizeof(void *) + sizeof(std::string_view) + 3 * sizeof(void *) +
+         key.size() + num_scores * sizeof(double);
+}
+
+bool ScoreCache::admitsLocked(const std::string &key, uint64_t bytes) const {
+  if (bytes > capacity_bytes_) return false;
+
+  // Compare against the victims from the least recently used end
+  uint32_t frequency = sketch_.estimate(key);
+  uint64_t free_bytes = capacity_bytes_ - size_bytes_;
+  for (auto it = entries_.rbegin(); free_bytes < bytes; ++it) {
+    if (sketch_.estimate(it->key) >= frequency) return false;
+    free_bytes += it->bytes;
+  }
+  return true;
+}
+
+void ScoreCache::evict() {
+  positions_.erase(entries_.back().key);
+  size_bytes_ -= entries_.back().bytes;
+  entries_.pop_back();
+  ++evictions_;
+}
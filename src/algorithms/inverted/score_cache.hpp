@@ -0,0 +1,85 @@
+#ifndef SCORE_CACHE_HPP
+#define SCORE_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "data-structures/frequency_sketch.hpp"
+
+/**
+ * Caches the scores of every posting of the most frequently queried terms.
+ *
+ * Entries are evicted least recently used first, but a new entry is only
+ * admitted if its key was queried more often recently than each entry it
+ * would evict (TinyLFU). So a burst of rare terms can't flush the hot ones.
+ * Every lookup counts towards the frequency estimates. All members are
+ * thread-safe, entries stay valid for their holders after eviction.
+ */
+class ScoreCache {
+ public:
+  using Scores = std::vector<double>;
+
+  /// Constructor.
+  explicit ScoreCache(uint64_t capacity_bytes);
+
+  /// Get the cached scores of key, nullptr if there are none. Counts an access of key.
+  std::shared_ptr<const Scores> lookup(const std::string &key);
+  /// Whether scores of num_scores postings for key would be admitted.
+  bool admits(const std::string &key, size_t num_scores);
+  /// Caches the scores of key if they are admitted.
+  void insert(const std::string &key, std::shared_ptr<const Scores> scores);
+  /// Drops all entries, keeps the statistics.
+  void clear();
+
+  /// Get the number of lookups that found an entry.
+  [[nodiscard]] uint64_t getHits();
+  /// Get the number of lookups that found no entry.
+  [[nodiscard]] uint64_t getMisses();
+  /// Get the share of lookups that found an entry.
+  [[nodiscard]] double getHitRate();
+  /// Get the number of admitted entries.
+  [[nodiscard]] uint64_t getAdmissions();
+  /// Get the number of entries that were not admitted.
+  [[nodiscard]] uint64_t getRejections();
+  /// Get the number of evicted entries.
+  [[nodiscard]] uint64_t getEvictions();
+  /// Get the estimated memory usage of all entries in bytes.
+  [[nodiscard]] uint64_t getSizeBytes();
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const Scores> scores;
+    uint64_t bytes;
+  };
+
+  /// The estimated memory usage of an entry.
+  static uint64_t entryBytes(const std::string &key, size_t num_scores);
+  /// Whether an entry of given size for key beats all entries it would evict. Requires the lock.
+  bool admitsLocked(const std::string &key, uint64_t bytes) const;
+  /// Removes the least recently used entry. Requires the lock.
+  void evict();
+
+  /// the entries, most recently used first
+  std::list<Entry> entries_;
+  /// key is an entry's key, value is its position in entries_
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> positions_;
+  /// the recent access frequency of all keys
+  FrequencySketch sketch_;
+  uint64_t capacity_bytes_;
+  uint64_t size_bytes_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t admissions_ = 0;
+  uint64_t rejections_ = 0;
+  uint64_t evictions_ = 0;
+  std::mutex mutex_;
+};
+
+#endif  // SCORE_CACHE_HPP
@@ -0,0 +1,310 @@
+#include "segmented_index_engine.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "data-structures/top_k.hpp"
+#include "tokenizer/stemmingtokenizer.hpp"
+#include "tokenizer/utf8tokenizer.hpp"
+
+SegmentedIndexEngine::SegmentedIndexEngine(bool use_stem_cache, bool unicode,
+                                           uint32_t merge_factor)
+    : stem_cache_(use_stem_cache ? std::make_unique<tokenizer::StemCache>() : nullptr),
+      unicode_(unicode),
+      merge_factor_(std::max(merge_factor, 2u)),
+      segments_(std::make_shared<const Segments>()) {
+  merge_thread_ = std::thread(&SegmentedIndexEngine::mergeSegments, this);
+}
+
+SegmentedIndexEngine::~SegmentedIndexEngine() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  merge_thread_.join();
+}
+
+void SegmentedIndexEngine::indexDocuments(std::string &data_path) {
+  if (!std::filesystem::is_directory(data_path)) {
+    addDocuments(data_path);
+    return;
+  }
+
+  std::vector<std::string> files;
+  for (const auto &entry : std::filesystem::directory_iterator(data_path)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+      files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  for (const auto &file : files) {
+    addDocuments(file);
+  }
+}
+
+void SegmentedIndexEngine::addDocuments(const std::string &data_path) {
+  // Only the new documents are indexed
+  auto segment = std::make_shared<const IndexSegment>(data_path, stem_cache_.get(), unicode_,
+                                                      NUM_THREADS);
+  {
+    std::lock_guard lock(mutex_);
+    // A live document of another segment would be scored twice
+    for (DocumentID doc_id : segment->getDocumentIds()) {
+      for (const auto &other : *segments_) {
+        if (other->contains(doc_id)) {
+          throw std::invalid_argument("Document " + std::to_string(doc_id) +
+                                      " is already indexed!");
+        }
+      }
+    }
+    auto segments = std::make_shared<Segments>(*segments_);
+    segments->push_back(std::move(segment));
+    segments_ = std::move(segments);
+  }
+  changed_.notify_all();
+  markIndexChanged();
+}
+
+bool SegmentedIndexEngine::deleteDocument(DocumentID doc_id) {
+  bool deleted;
+  {
+    std::lock_guard lock(mutex_);
+    deleted = deleteLocked(doc_id);
+  }
+  if (deleted) {
+    changed_.notify_all();
+    markIndexChanged();
+  }
+  return deleted;
+}
+
+void SegmentedIndexEngine::updateDocuments(const std::string &data_path) {
+  auto segment = std::make_shared<const IndexSegment>(data_path, stem_cache_.get(), unicode_,
+                                                      NUM_THREADS);
+  {
+    // Queries see either the old or the new documents
+    std::lock_guard lock(mutex_);
+    for (DocumentID doc_id : segment->getDocumentIds()) {
+      deleteLocked(doc_id);
+    }
+    auto segments = std::make_shared<Segments>(*segments_);
+    segments->push_back(std::move(segment));
+    segments_ = std::move(segments);
+  }
+  changed_.notify_all();
+  markIndexChanged();
+}
+
+bool SegmentedIndexEngine::deleteLocked(DocumentID doc_id) {
+  bool deleted = false;
+  for (const auto &segment : *segments_) {
+    deleted |= segment->deleteDocument(doc_id);
+  }
+  if (deleted && merging_) {
+    pending_deletes_.push_back(doc_id);
+  }
+  return deleted;
+}
+
+std::vector<std::pair<DocumentID, double>> SegmentedIndexEngine::search(
+    const std::string &query, const scoring::ScoringFunction &score_func, uint32_t num_results) {
+  // The segments stay alive until the query is answered
+  auto segments = getSegments();
+  auto tokenizer = makeQueryTokenizer(query);
+
+  // The postings of every query token in every segment
+  struct QueryTerm {
+    const IndexSegment *segment;
+    const IndexSegment::Postings *postings;
+    uint32_t document_frequency;
+  };
+  thread_local std::vector<QueryTerm> terms;
+  terms.clear();
+  for (auto token = tokenizer->nextToken(true); !token.empty();
+       token = tokenizer->nextToken(true)) {
+    size_t first_term = terms.size();
+    uint32_t document_frequency = 0;
+    for (const auto &segment : *segments) {
+      if (const auto *postings = segment->find(token)) {
+        terms.push_back({segment.get(), postings, 0});
+        document_frequency += static_cast<uint32_t>(postings->size());
+      }
+    }
+    // The token is scored by its frequency in all segments
+    for (size_t i = first_term; i < terms.size(); ++i) {
+      terms[i].document_frequency = document_frequency;
+    }
+  }
+
+  thread_local std::unordered_map<DocumentID, double> doc_to_score;
+  doc_to_score.clear();
+  for (const auto &[segment, postings, document_frequency] : terms) {
+    for (const auto &[doc_id, freq] : *postings) {
+      // An updated document is live only in its newest segment
+      if (segment->isDeleted(doc_id)) {
+        continue;
+      }
+      doc_to_score[doc_id] +=
+          score_func.score({segment->getDocumentLength(doc_id)}, {freq, document_frequency});
+    }
+  }
+
+  TopK results(num_results);
+  for (const auto &[doc_id, score] : doc_to_score) {
+    results.push(score, doc_id);
+  }
+  return results.extract();
+}
+
+std::string SegmentedIndexEngine::normalizeQuery(const std::string &query) {
+  std::string normalized;
+  auto tokenizer = makeQueryTokenizer(query);
+  for (auto token = tokenizer->nextToken(true); !token.empty();
+       token = tokenizer->nextToken(true)) {
+    normalized.append(token).push_back(' ');
+  }
+  return normalized;
+}
+
+std::unique_ptr<tokenizer::ITokenizer> SegmentedIndexEngine::makeQueryTokenizer(
+    const std::string &query) const {
+  if (unicode_) {
+    return std::make_unique<tokenizer::Utf8Tokenizer>(query.c_str(), query.size(), true,
+                                                      stem_cache_.get());
+  }
+  return std::make_unique<tokenizer::StemmingTokenizer>(query.c_str(), query.size(),
+                                                        stem_cache_.get());
+}
+
+void SegmentedIndexEngine::waitForMerges() {
+  std::unique_lock lock(mutex_);
+  changed_.wait(lock, [this]() { return !merging_ && pickMerge().empty(); });
+}
+
+size_t SegmentedIndexEngine::getSegmentCount() { return getSegments()->size(); }
+
+uint64_t SegmentedIndexEngine::getMergeCount() {
+  std::lock_guard lock(mutex_);
+  return merge_count_;
+}
+
+std::shared_ptr<const SegmentedIndexEngine::Segments> SegmentedIndexEngine::getSegments() {
+  std::lock_guard lock(mutex_);
+  return segments_;
+}
+
+SegmentedIndexEngine::Segments SegmentedIndexEngine::pickMerge() const {
+  // Reclaim the space of mostly deleted segments first
+  for (const auto &segment : *segments_) {
+    if (segment->getDeletedCount() * 2 > segment->getDocumentCount()) {
+      return {segment};
+    }
+  }
+
+  // Group the segments by the logarithm of their live document count
+  std::map<uint32_t, Segments> tiers;
+  for (const auto &segment : *segments_) {
+    uint32_t tier = 0;
+    for (uint64_t count = segment->getDocumentCount() - segment->getDeletedCount();
+         count >= merge_factor_;
+         count /= merge_factor_) {
+      ++tier;
+    }
+    tiers[tier].push_back(segment);
+  }
+
+  for (auto &[tier, segments] : tiers) {
+    if (segments.size() >= merge_factor_) {
+      segments.resize(merge_factor_);
+      return segments;
+    }
+  }
+  return {};
+}
+
+void SegmentedIndexEngine::mergeSegments() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    Segments inputs;
+    changed_.wait(lock, [&]() {
+      inputs = pickMerge();
+      return stopping_ || !inputs.empty();
+    });
+    if (stopping_) {
+      return;
+    }
+
+    // Queries keep using the inputs while they are merged
+    merging_ = true;
+    pending_deletes_.clear();
+    lock.unlock();
+    auto merged = std::make_shared<const IndexSegment>(inputs);
+    uint64_t num_inputs = 0;
+    for (const auto &segment : inputs) {
+      num_inputs += segment->getDocumentCount();
+    }
+    lock.lock();
+    for (DocumentID doc_id : pending_deletes_) {
+      merged->deleteDocument(doc_id);
+    }
+
+    // Segments added meanwhile are kept
+    auto segments = std::make_shared<Segments>();
+    for (const auto &segment : *segments_) {
+      if (std::find(inputs.begin(), inputs.end(), segment) == inputs.end()) {
+        segments->push_back(segment);
+      }
+    }
+    uint32_t merged_count = merged->getDocumentCount();
+    if (merged_count > 0) {
+      segments->push_back(std::move(merged));
+    }
+    segments_ = std::move(segments);
+    merging_ = false;
+    ++merge_count_;
+    // The postings of the deleted documents are gone, which changes document frequencies
+    if (merged_count < num_inputs) {
+      markIndexChanged();
+    }
+    changed_.notify_all();
+  }
+}
+
+uint64_t SegmentedIndexEngine::footprint_size() {
+  uint64_t size = sizeof(SegmentedIndexEngine);
+  for (const auto &segment : *getSegments()) {
+    size += segment->footprint_size();
+  }
+  return size;
+}
+
+uint64_t SegmentedIndexEngine::footprint_capacity() {
+  uint64_t size = sizeof(SegmentedIndexEngine);
+  for (const auto &segment : *getSegments()) {
+    size += segment->footprint_capacity();
+  }
+  return size;
+}
+
+uint32_t SegmentedIndexEngine::getDocumentCount() {
+  uint32_t count = 0;
+  for (const auto &segment : *getSegments()) {
+    count += segment->getDocumentCount() - segment->getDeletedCount();
+  }
+  return count;
+}
+
+double SegmentedIndexEngine::getAvgDocumentLength() {
+  uint64_t num_tokens = 0;
+  uint64_t num_docs = 0;
+  for (const auto &segment : *getSegments()) {
+    num_tokens += segment->getTokenCount() - segment->getDeletedTokenCount();
+    num_docs += segment->getDocumentCount() - segment->getDeletedCount();
+  }
+  return num_docs == 0 ? 0.0 : static_cast<double>(num_tokens) / static_cast<double>(num_docs);
+}
@@ -0,0 +1,133 @@
+#ifndef SEGMENTED_INDEX_ENGINE_HPP
+#define SEGMENTED_INDEX_ENGINE_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fts_engine.hpp"
+#include "index_segment.hpp"
+#include "tokenizer/ITokenizer.hpp"
+#include "tokenizer/stem_cache.hpp"
+
+/**
+ * An inverted index made of immutable segments, to which documents can be added.
+ *
+ * Every addDocuments indexes only the new documents into a segment of their own, which
+ * is searchable once the call returns. Queries score the postings of all segments with
+ * the document frequencies summed over the segments, so they rank like one inverted
+ * index of all documents. A background thread merges merge_factor segments of the same
+ * size tier into one, so the number of segments grows only logarithmically.
+ *
+ * Deleted documents are marked in their segments' tombstones and skipped by queries,
+ * but still count in the document frequencies until a merge drops their postings. A
+ * segment with more deleted than live documents is rewritten on its own.
+ */
+class SegmentedIndexEngine : public FullTextSearchEngine {
+ public:
+  /// Constructor. Memoizes stems of frequent surface forms if use_stem_cache is set.
+  /// Keeps and case-folds non-ASCII letters if unicode is set. A segment's size tier is
+  /// the logarithm of its document count to the base merge_factor.
+  explicit SegmentedIndexEngine(bool use_stem_cache = true, bool unicode = false,
+                                uint32_t merge_factor = 4);
+
+  /// Destructor. Waits for a running merge to finish.
+  ~SegmentedIndexEngine() override;
+
+  /// Adds every Parquet file of data_path as a segment of its own.
+  void indexDocuments(std::string &data_path) override;
+
+  /// Indexes the documents of a Parquet file or directory into a new segment. Throws
+  /// std::invalid_argument if one of them is already indexed and not deleted, replacing
+  /// documents is up to updateDocuments.
+  void addDocuments(const std::string &data_path);
+
+  /// Deletes a document, returns false if it isn't indexed or already deleted.
+  bool deleteDocument(DocumentID doc_id);
+
+  /// Replaces the indexed documents with the ids of data_path by its documents and adds
+  /// the other ones, as one new segment.
+  void updateDocuments(const std::string &data_path);
+
+  std::vector<std::pair<DocumentID, double>> search(const std::string &query,
+                                                    const scoring::ScoringFunction &score_func,
+                                                    uint32_t num_results) override;
+
+  uint64_t footprint_size() override;
+
+  uint64_t footprint_capacity() override;
+
+  uint32_t getDocumentCount() override;
+
+  double getAvgDocumentLength() override;
+
+  /// Returns the stemmed query tokens without stop words.
+  std::string normalizeQuery(const std::string &query) override;
+
+  /// Blocks until no merge is due or running.
+  void waitForMerges();
+
+  /// Get the number of segments.
+  size_t getSegmentCount();
+
+  /// Get the number of merges done.
+  uint64_t getMergeCount();
+
+ private:
+  using Segments = std::vector<std::shared_ptr<const IndexSegment>>;
+
+  /// Get the current segments, which stay valid while they are merged.
+  std::shared_ptr<const Segments> getSegments();
+
+  /// Creates the tokenizer splitting a query like the indexed documents.
+  std::unique_ptr<tokenizer::ITokenizer> makeQueryTokenizer(const std::string &query) const;
+
+  /// Marks a document deleted in all segments, the lock has to be held.
+  bool deleteLocked(DocumentID doc_id);
+
+  /// Picks a segment with more deleted than live documents, else merge_factor_ segments
+  /// of the lowest full size tier, none if no tier is full.
+  Segments pickMerge() const;
+
+  /// Merges segments in the background until the engine is destroyed.
+  void mergeSegments();
+
+  const uint64_t NUM_THREADS = std::thread::hardware_concurrency();
+
+  /// memoized stems shared by all tokenizers of this engine, nullptr if disabled
+  std::unique_ptr<tokenizer::StemCache> stem_cache_;
+
+  /// whether documents and queries are tokenized as UTF-8
+  bool unicode_;
+
+  /// number of segments of a size tier that are merged
+  uint32_t merge_factor_;
+
+  /// guards the following members
+  std::mutex mutex_;
+
+  /// signals added segments, finished merges and destruction
+  std::condition_variable changed_;
+
+  /// the searchable segments, replaced as a whole when a segment is added or merged
+  std::shared_ptr<const Segments> segments_;
+
+  /// whether the merge thread is merging segments
+  bool merging_ = false;
+
+  /// documents deleted while merging, also deleted from the merged segment
+  std::vector<DocumentID> pending_deletes_;
+
+  /// number of merges done
+  uint64_t merge_count_ = 0;
+
+  /// whether the merge thread has to stop
+  bool stopping_ = false;
+
+  /// merges the segments in the background
+  std::thread merge_thread_;
+};
+
+#endif  // SEGMENTED_INDEX_ENGINE_HPP
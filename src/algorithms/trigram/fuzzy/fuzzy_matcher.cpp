@@ -0,0 +1,137 @@
+#include <algorithm>
+//---------------------------------------------------------------------------
+#include "fuzzy_matcher.hpp"
+#include "levenshtein.hpp"
+//---------------------------------------------------------------------------
+namespace trigramlib {
+//---------------------------------------------------------------------------
+void FuzzyMatcher::build(std::vector<std::pair<std::string, uint32_t>> vocabulary) {
+  std::sort(vocabulary.begin(), vocabulary.end());
+
+  terms.clear();
+  frequencies.clear();
+  trigram_counts.clear();
+  terms.reserve(vocabulary.size());
+  frequencies.reserve(vocabulary.size());
+  trigram_counts.reserve(vocabulary.size());
+
+  // (trigram, term ID) pairs, grouped by trigram below
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  std::vector<uint32_t> trigrams;
+  for (auto& [term, frequency] : vocabulary) {
+    auto term_id = static_cast<uint32_t>(terms.size());
+    trigrams.clear();
+    paddedTrigrams(term, trigrams);
+    for (uint32_t trigram : trigrams) pairs.emplace_back(trigram, term_id);
+
+    terms.push_back(std::move(term));
+    frequencies.push_back(frequency);
+    trigram_counts.push_back(static_cast<uint32_t>(trigrams.size()));
+  }
+  std::sort(pairs.begin(), pairs.end());
+
+  trigram_keys.clear();
+  posting_offsets.clear();
+  posting_terms.clear();
+  posting_terms.reserve(pairs.size());
+  for (const auto& [trigram, term_id] : pairs) {
+    if (trigram_keys.empty() || trigram_keys.back() != trigram) {
+      trigram_keys.push_back(trigram);
+      posting_offsets.push_back(static_cast<uint32_t>(posting_terms.size()));
+    }
+    posting_terms.push_back(term_id);
+  }
+  posting_offsets.push_back(static_cast<uint32_t>(posting_terms.size()));
+}
+//---------------------------------------------------------------------------
+std::string_view FuzzyMatcher::correct(std::string_view word, uint32_t max_distance) const {
+  if (max_distance == 0 || word.size() < kMinWordLength || word.size() > kMaxWordLength) {
+    return word;
+  }
+  auto exact = std::lower_bound(terms.begin(), terms.end(), word);
+  if (exact != terms.end() && *exact == word) return word;
+
+  std::vector<uint32_t> word_trigrams;
+  paddedTrigrams(word, word_trigrams);
+
+  // Count the shared trigrams per term. The scratch space lives as long as the thread,
+  // only the touched counters are reset.
+  thread_local std::vector<uint16_t> shared;
+  thread_local std::vector<uint32_t> touched;
+  shared.resize(std::max(shared.size(), terms.size()));
+  touched.clear();
+
+  for (uint32_t trigram : word_trigrams) {
+    auto key = std::lower_bound(trigram_keys.begin(), trigram_keys.end(), trigram);
+    if (key == trigram_keys.end() || *key != trigram) continue;
+    size_t i = key - trigram_keys.begin();
+    for (uint32_t p = posting_offsets[i]; p < posting_offsets[i + 1]; ++p) {
+      uint32_t term_id = posting_terms[p];
+      if (terms[term_id].size() + max_distance < word.size() ||
+          word.size() + max_distance < terms[term_id].size()) {
+        continue;
+      }
+      if (shared[term_id]++ == 0) touched.push_back(term_id);
+    }
+  }
+
+  BoundedLevenshtein levenshtein(word);
+  std::string_view best = word;
+  uint32_t best_distance = max_distance + 1;
+  uint32_t best_frequency = 0;
+  for (uint32_t term_id : touched) {
+    auto required = static_cast<int64_t>(std::max<size_t>(word_trigrams.size(),
+                                                          trigram_counts[term_id])) -
+                    3 * static_cast<int64_t>(max_distance);
+    bool candidate = shared[term_id] >= required;
+    shared[term_id] = 0;
+    if (!candidate) continue;
+
+    uint32_t distance = levenshtein.distance(terms[term_id], max_distance);
+    if (distance > max_distance) continue;
+    if (distance < best_distance ||
+        (distance == best_distance && frequencies[term_id] > best_frequency)) {
+      best = terms[term_id];
+      best_distance = distance;
+      best_frequency = frequencies[term_id];
+    }
+  }
+  return best;
+}
+//---------------------------------------------------------------------------
+void FuzzyMatcher::paddedTrigrams(std::string_view word, std::vector<uint32_t>& out) {
+  size_t first = out.size();
+  auto byte = [&word](int64_t i) -> uint32_t {
+    return i < 0 || i >= static_cast<int64_t>(word.size()) ? ' '
+                                                            : static_cast<uint8_t>(word[i]);
+  };
+  for (int64_t i = -2; i < static_cast<int64_t>(word.size()) - 1; ++i) {
+    out.push_back((byte(i) << 16) | (byte(i + 1) << 8) | byte(i + 2));
+  }
+  std::sort(out.begin() + first, out.end());
+  out.erase(std::unique(out.begin() + first, out.end()), out.end());
+}
+//---------------------------------------------------------------------------
+uint64_t FuzzyMatcher::footprint_capacity() const {
+  uint64_t size = terms.capacity() * sizeof(std::string);
+  for (const auto& term : terms) size += term.capacity();
+  size += frequencies.capacity() * sizeof(uint32_t);
+  size += trigram_counts.capacity() * sizeof(uint32_t);
+  size += trigram_keys.capacity() * sizeof(uint32_t);
+  size += posting_offsets.capacity() * sizeof(uint32_t);
+  size += posting_terms.capacity() * sizeof(uint32_t);
+  return size;
+}
+//---------------------------------------------------------------------------
+uint64_t FuzzyMatcher::footprint_size() const {
+  uint64_t size = terms.size() * sizeof(std::string);
+  for (const auto& term : terms) size += term.size();
+  size += frequencies.size() * sizeof(uint32_t);
+  size += trigram_counts.size() * sizeof(uint32_t);
+  size += trigram_keys.size() * sizeof(uint32_t);
+  size += posting_offsets.size() * sizeof(uint32_t);
+  size += posting_terms.size() * sizeof(uint32_t);
+  return size;
+}
+//---------------------------------------------------------------------------
+}  // namespace trigramlib
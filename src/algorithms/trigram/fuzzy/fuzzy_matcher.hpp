@@ -0,0 +1,65 @@
+#ifndef FUZZY_MATCHER_HPP
+#define FUZZY_MATCHER_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+//---------------------------------------------------------------------------
+namespace trigramlib {
+//---------------------------------------------------------------------------
+/**
+ * Corrects misspelled words against the vocabulary of the indexed documents.
+ *
+ * Every term is padded with two leading and one trailing space and indexed by
+ * its distinct trigrams. One edit changes at most three trigrams, so a term
+ * within k edits of a word shares at least max(|T(word)|, |T(term)|) - 3k of
+ * them. Terms passing this count filter and a length filter are verified with
+ * BoundedLevenshtein.
+ */
+class FuzzyMatcher {
+ public:
+  /// Words shorter than this are never corrected.
+  static constexpr size_t kMinWordLength = 3;
+  /// Words longer than this are never corrected.
+  static constexpr size_t kMaxWordLength = 64;
+
+  /// @brief Replaces the vocabulary.
+  /// @param vocabulary The terms and their document frequencies.
+  void build(std::vector<std::pair<std::string, uint32_t>> vocabulary);
+  /// @brief Finds the closest term to a lower-cased word.
+  /// Prefers the smaller distance, then the higher document frequency.
+  /// @param word The word to correct.
+  /// @param max_distance The maximum number of edits.
+  /// @return The word itself if it is a term or cannot be corrected, the closest term otherwise.
+  [[nodiscard]] std::string_view correct(std::string_view word, uint32_t max_distance) const;
+
+  /// Get the number of terms.
+  [[nodiscard]] size_t size() const { return terms.size(); }
+  /// Determines the allocated memory footprint in bytes.
+  [[nodiscard]] uint64_t footprint_capacity() const;
+  /// Determines the used memory footprint in bytes.
+  [[nodiscard]] uint64_t footprint_size() const;
+
+ private:
+  /// Appends the distinct padded trigrams of given word to out.
+  static void paddedTrigrams(std::string_view word, std::vector<uint32_t>& out);
+
+  /// The terms, sorted.
+  std::vector<std::string> terms;
+  /// The document frequency of every term.
+  std::vector<uint32_t> frequencies;
+  /// The number of distinct padded trigrams of every term.
+  std::vector<uint32_t> trigram_counts;
+  /// The distinct padded trigrams of all terms, sorted.
+  std::vector<uint32_t> trigram_keys;
+  /// The terms containing trigram_keys[i] are posting_terms[posting_offsets[i], [i + 1]).
+  std::vector<uint32_t> posting_offsets;
+  /// The term IDs per trigram, increasing.
+  std::vector<uint32_t> posting_terms;
+};
+//---------------------------------------------------------------------------
+}  // namespace trigramlib
+//---------------------------------------------------------------------------
+#endif  // FUZZY_MATCHER_HPP
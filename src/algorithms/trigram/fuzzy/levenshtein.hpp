@@ -0,0 +1,73 @@
+#ifndef LEVENSHTEIN_HPP
+#define LEVENSHTEIN_HPP
+//---------------------------------------------------------------------------
+#include <array>
+#include <cstdint>
+#include <string_view>
+//---------------------------------------------------------------------------
+namespace trigramlib {
+//---------------------------------------------------------------------------
+/**
+ * Bounded Levenshtein distance from one pattern to many texts.
+ *
+ * Uses Myers' bit-parallel algorithm (in Hyyrö's formulation): a whole column of
+ * the dynamic programming matrix is kept in two 64-bit vectors, so comparing a
+ * text of length n costs O(n) word operations. The pattern is limited to 64 bytes.
+ */
+class BoundedLevenshtein {
+ public:
+  /// The maximum length of a pattern.
+  static constexpr size_t kMaxPatternLength = 64;
+
+  /// Constructor. Requires pattern.size() <= kMaxPatternLength.
+  explicit BoundedLevenshtein(std::string_view pattern) : length(pattern.size()), peq{} {
+    for (size_t i = 0; i < length; ++i) {
+      peq[static_cast<uint8_t>(pattern[i])] |= uint64_t{1} << i;
+    }
+  }
+
+  /// The edit distance between the pattern and text, or max_distance + 1 if it exceeds
+  /// max_distance.
+  [[nodiscard]] uint32_t distance(std::string_view text, uint32_t max_distance) const {
+    if (length == 0) return bounded(text.size(), max_distance);
+
+    uint64_t pv = ~uint64_t{0};
+    uint64_t mv = 0;
+    uint64_t last = uint64_t{1} << (length - 1);
+    auto score = static_cast<int64_t>(length);
+
+    for (size_t j = 0; j < text.size(); ++j) {
+      uint64_t eq = peq[static_cast<uint8_t>(text[j])];
+      uint64_t xv = eq | mv;
+      uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+      uint64_t ph = mv | ~(xh | pv);
+      uint64_t mh = pv & xh;
+      if (ph & last) ++score;
+      if (mh & last) --score;
+      // The top row of the matrix grows by one per text character.
+      ph = (ph << 1) | 1;
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+
+      // The remaining characters can lower the score by at most one each.
+      auto remaining = static_cast<int64_t>(text.size() - j - 1);
+      if (score - remaining > static_cast<int64_t>(max_distance)) return max_distance + 1;
+    }
+    return bounded(static_cast<size_t>(score), max_distance);
+  }
+
+ private:
+  static uint32_t bounded(size_t distance, uint32_t max_distance) {
+    return distance > max_distance ? max_distance + 1 : static_cast<uint32_t>(distance);
+  }
+
+  /// The length of the pattern.
+  size_t length;
+  /// For every byte value, the positions at which it occurs in the pattern.
+  std::array<uint64_t, 256> peq;
+};
+//---------------------------------------------------------------------------
+}  // namespace trigramlib
+//---------------------------------------------------------------------------
+#endif  // LEVENSHTEIN_HPP
@@ -122,16 +122,16 @@ class HashIndex : public Index<DocFreq, std::vector<DocFreq>, BucketSize> {
     }
   }
   //---------------------------------------------------------------------------
-  std::vector<DocFreq>* lookup(Trigram key) override {
+  std::span<const DocFreq> lookup(Trigram key) override {
     auto it = table.find(key);
     if (it != table.end()) {
       uint8_t offset = key.getWordOffset();
       if (offset >= BucketSize) {
         offset = BucketSize - 1;
       }
-      return &it->second.containers[offset];
+      return it->second.containers[offset];
     }
-    return nullptr;
+    return {};
   }
   //---------------------------------------------------------------------------
   /**
@@ -2,6 +2,7 @@
 #define TRIGRAM_INDEX_INTERFACE_HPP
 //---------------------------------------------------------------------------
 #include <fstream>
+#include <span>
 //---------------------------------------------------------------------------
 #include "algorithms/trigram/models/trigram.hpp"
 //---------------------------------------------------------------------------
@@ -14,8 +15,8 @@ class Index {
   virtual ~Index() = default;
   /// Insert a key-value pair into the index.
   virtual void insert(Trigram key, ValueT value) = 0;
-  /// Lookup the value for given trigram.
-  virtual ContainerT* lookup(Trigram key) = 0;
+  /// Lookup the values for given trigram, empty if there are none.
+  virtual std::span<const ValueT> lookup(Trigram key) = 0;
   /// Write the underlying data structure to specified file.
   virtual void store(std::ofstream& file) = 0;
   /// Load the underlying data structure from given data.
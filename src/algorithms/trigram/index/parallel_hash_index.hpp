@@ -1,8 +1,14 @@
 #ifndef TRIGRAM_PARALLEL_HASH_INDEX_HPP
 #define TRIGRAM_PARALLEL_HASH_INDEX_HPP
 //---------------------------------------------------------------------------
+#include <memory>
+#include <unordered_set>
+//---------------------------------------------------------------------------
 #include "algorithms/trigram/models/doc_freq.hpp"
 #include "algorithms/trigram/models/trigram.hpp"
+#include "data-structures/arena.hpp"
+#include "data-structures/chunked_list.hpp"
+#include "data-structures/packed_postings.hpp"
 #include "data-structures/parallel_hash_table.hpp"
 #include "index.hpp"
 //---------------------------------------------------------------------------
@@ -11,13 +17,26 @@ template <size_t TableSize, uint8_t MaxOffset>
 class ParallelHashIndex : public Index<DocFreq, std::vector<DocFreq>, MaxOffset> {
  public:
   /// Constructor.
-  ParallelHashIndex() : table(TableSize) {}
+  ParallelHashIndex()
+      : chain_arena(std::make_unique<Arena>()),
+        build_arena(std::make_unique<Arena>()),
+        table(TableSize, chain_arena.get()) {}
   /// Move Constructor.
-  ParallelHashIndex(ParallelHashIndex&& other) noexcept : table(std::move(other.table)) {}
+  ParallelHashIndex(ParallelHashIndex&& other) noexcept
+      : chain_arena(std::move(other.chain_arena)),
+        build_arena(std::move(other.build_arena)),
+        table(std::move(other.table)),
+        packed(std::move(other.packed)),
+        stop_trigrams(std::move(other.stop_trigrams)) {}
   /// Move assignment.
   ParallelHashIndex& operator=(ParallelHashIndex&& other) noexcept {
     if (this != &other) {
+      // The chains go before their arena
       table = std::move(other.table);
+      chain_arena = std::move(other.chain_arena);
+      build_arena = std::move(other.build_arena);
+      packed = std::move(other.packed);
+      stop_trigrams = std::move(other.stop_trigrams);
     }
     return *this;
   }
@@ -29,15 +48,69 @@ class ParallelHashIndex : public Index<DocFreq, std::vector<DocFreq>, MaxOffset>
     if (offset >= MaxOffset) {
       key.setWordOffset(MaxOffset - 1);
     }
+    // Trigrams dropped as too frequent stay dropped for documents added later
+    if (stop_trigrams.contains(key.getRawValue())) return;
+
+    auto push_occurence = [&value, this](Occurences& occurences) {
+      occurences.added.push_back(value, *build_arena);
+    };
+
+    table.updateOrInsert(key.getRawValue(), push_occurence, Occurences{});
+  }
+  //---------------------------------------------------------------------------
+  /// Inserts all occurences of a trigram at once.
+  void insertAll(Trigram key, const std::vector<DocFreq>& values) {
+    if (key.getWordOffset() >= MaxOffset) key.setWordOffset(MaxOffset - 1);
+    if (stop_trigrams.contains(key.getRawValue())) return;
 
-    auto push_occurence = [&value](std::vector<DocFreq>& occurences) {
-      occurences.push_back(value);
+    auto append_occurences = [&values](Occurences& occurences) {
+      occurences.list.insert(occurences.list.end(), values.begin(), values.end());
     };
+    table.updateOrInsert(key.getRawValue(), append_occurences, Occurences{});
+  }
+  //---------------------------------------------------------------------------
+  /// Packs the occurences inserted since the last call together with the finalized ones
+  /// into one buffer, which lookups read, and frees the table and the chunks. Inserts need
+  /// reopen afterwards.
+  void finalize() {
+    uint64_t num_occurences = packed.getPostingCount();
+    for (auto& [key, value] : table) num_occurences += value.list.size() + value.added.size();
+    Packed finalized;
+    finalized.reserve(num_occurences);
+
+    // The finalized lists keep their order and get the new occurences appended
+    for (uint32_t index = 0; index < packed.size(); ++index) {
+      Occurences* occurences = table.get(packed.key(index));
+      std::span<const DocFreq> old_list = packed.postings(index);
+      uint64_t count = old_list.size() + (occurences != nullptr ? occurences->size() : 0);
+      if (count == 0) continue;
+      uint32_t new_index = finalized.add(packed.key(index), count);
+      DocFreq* out = finalized.postings(new_index).data();
+      out = std::copy(old_list.begin(), old_list.end(), out);
+      if (occurences != nullptr) moveOccurences(*occurences, out);
+    }
+    for (auto& [key, value] : table) {
+      if (value.size() == 0 || packed.find(key) != Packed::kNotFound) continue;
+      moveOccurences(value, finalized.postings(finalized.add(key, value.size())).data());
+    }
 
-    table.updateOrInsert(key.getRawValue(), push_occurence, std::vector<DocFreq>{});
+    packed = std::move(finalized);
+    table = ParallelHashTable<uint32_t, Occurences>(1, chain_arena.get());
+    chain_arena->release();
+    build_arena->release();
+  }
+  //---------------------------------------------------------------------------
+  /// Prepares inserts after finalize.
+  void reopen() {
+    if (table.size() < TableSize) {
+      table = ParallelHashTable<uint32_t, Occurences>(TableSize, chain_arena.get());
+    }
   }
   //---------------------------------------------------------------------------
-  std::vector<DocFreq>* lookup(Trigram key) override { return table.get(key.getRawValue()); }
+  std::span<const DocFreq> lookup(Trigram key) override {
+    uint32_t index = packed.find(key.getRawValue());
+    return index != Packed::kNotFound ? packed.postings(index) : std::span<const DocFreq>();
+  }
   //---------------------------------------------------------------------------
   void store(std::ofstream& file) override {
     // TODO
@@ -54,8 +127,10 @@ class ParallelHashIndex : public Index<DocFreq, std::vector<DocFreq>, MaxOffset>
     size += table.footprint_capacity();
     // Size known at runtime
     for (auto& [key, value] : table) {
-      size += (value.capacity() * sizeof(DocFreq));
+      size += (value.list.capacity() * sizeof(DocFreq));
     }
+    size += build_arena->footprint();
+    size += packed.footprint_capacity();
 
     return size;
   }
@@ -67,8 +142,9 @@ class ParallelHashIndex : public Index<DocFreq, std::vector<DocFreq>, MaxOffset>
     size += table.footprint_size();
     // Size known at runtime
     for (auto& [key, value] : table) {
-      size += (value.size() * sizeof(DocFreq));
+      size += (value.list.size() * sizeof(DocFreq));
     }
+    size += packed.footprint_size();
 
     return size;
   }
@@ -76,15 +152,53 @@ class ParallelHashIndex : public Index<DocFreq, std::vector<DocFreq>, MaxOffset>
   void compactify(uint32_t max_occurences) {
     for (auto& [key, value] : table) {
       if (value.size() > max_occurences) {
-        value.clear();
-        value.shrink_to_fit();
+        stop_trigrams.insert(key);
+        value.list.clear();
+        value.list.shrink_to_fit();
+        value.added.clear(*build_arena);
       }
     }
   }
+  //---------------------------------------------------------------------------
+  /// Removes the finalized occurences the predicate holds for.
+  template <typename Predicate>
+  void removeIf(Predicate predicate) {
+    packed.removeIf(
+        [&predicate](uint32_t, const DocFreq& occurence) { return predicate(occurence); });
+  }
 
  private:
-  /// A mapping of trigram to buckets.
-  ParallelHashTable<uint32_t, std::vector<DocFreq>> table;
+  /// The occurences of a trigram.
+  struct Occurences {
+    /// The occurences of spilled runs.
+    std::vector<DocFreq> list;
+    /// The occurences inserted one by one, in the build arena.
+    ChunkedList<DocFreq> added;
+
+    /// Get the number of occurences.
+    [[nodiscard]] uint64_t size() const { return list.size() + added.size(); }
+  };
+  /// The finalized occurences by trigram.
+  using Packed = PackedPostings<uint32_t, DocFreq>;
+
+  /// Moves the occurences to out and frees them.
+  void moveOccurences(Occurences& occurences, DocFreq* out) {
+    out = std::copy(occurences.list.begin(), occurences.list.end(), out);
+    occurences.added.copyTo(out);
+    occurences.list = {};
+    occurences.added.clear(*build_arena);
+  }
+
+  /// The chains of the table's buckets.
+  std::unique_ptr<Arena> chain_arena;
+  /// The chunks of the inserted occurences.
+  std::unique_ptr<Arena> build_arena;
+  /// A mapping of trigram to the occurences inserted since the last finalize.
+  ParallelHashTable<uint32_t, Occurences> table;
+  /// The occurences visible to lookups.
+  Packed packed;
+  /// The trigrams dropped by compactify.
+  std::unordered_set<uint32_t> stop_trigrams;
 };
 //---------------------------------------------------------------------------
 }  // namespace trigramlib
@@ -17,9 +17,9 @@ struct Trigram {
   explicit Trigram(uint32_t raw_value) : value(raw_value) {}
   /// Constructor from char pointer.
   Trigram(const char* trigram, uint8_t word_offset)
-      : value((static_cast<uint32_t>(*trigram) << 24) |
-              (static_cast<uint32_t>(*(trigram + 1)) << 16) |
-              (static_cast<uint32_t>(*(trigram + 2)) << 8) | word_offset) {}
+      : value((static_cast<uint32_t>(static_cast<uint8_t>(*trigram)) << 24) |
+              (static_cast<uint32_t>(static_cast<uint8_t>(*(trigram + 1))) << 16) |
+              (static_cast<uint32_t>(static_cast<uint8_t>(*(trigram + 2))) << 8) | word_offset) {}
 
   /// Equality operator.
   /// Note: Two trigrams are equal if they consist of the same 3 letters.
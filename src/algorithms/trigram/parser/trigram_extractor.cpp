@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+//---------------------------------------------------------------------------
+#include "tokenizer/simd_scan.hpp"
+#include "tokenizer/tokenizer_rules.hpp"
+#include "trigram_extractor.hpp"
+//---------------------------------------------------------------------------
+namespace trigramlib {
+//---------------------------------------------------------------------------
+TrigramExtractor::TrigramExtractor(bool non_ascii) : non_ascii(non_ascii) {}
+//---------------------------------------------------------------------------
+void TrigramExtractor::extract(const char* begin, const char* end, std::vector<uint32_t>& out,
+                               std::vector<std::string_view>* words) {
+  out.clear();
+  if (words != nullptr) words->clear();
+  auto size = static_cast<size_t>(end - begin);
+  lowered.resize(size + 1);
+  tokenizer::toLower(begin, size, lowered.data());
+  lowered[size] = '\0';
+  classify(begin, size);
+
+  for (size_t word_begin = findBit(0, size, true); word_begin < size;) {
+    size_t word_end = findBit(word_begin, size, false);
+    size_t length = word_end - word_begin;
+    if (words != nullptr) words->emplace_back(lowered.data() + word_begin, length);
+
+    if (length >= 2) {
+      // Like TrigramParser, a two-character word only counts if a delimiter follows it.
+      size_t count = length >= 3 ? length - 2 : (word_end < size ? 1 : 0);
+      const char* it = lowered.data() + word_begin;
+      for (size_t offset = 0; offset < count; ++offset) {
+        uint32_t bytes;
+        std::memcpy(&bytes, it + offset, sizeof(bytes));
+        // The first byte ends up most significant, the fourth is replaced by the offset.
+        uint32_t trigram = std::byteswap(bytes) & 0xFFFFFF00;
+        // A two-character word has a zero third character.
+        if (length == 2) trigram &= 0xFFFF0000;
+        out.push_back(trigram | static_cast<uint8_t>(offset));
+      }
+    }
+
+    word_begin = findBit(word_end, size, true);
+  }
+}
+//---------------------------------------------------------------------------
+void TrigramExtractor::classify(const char* begin, size_t size) {
+  word_mask.assign((size + 63) / 64, 0);
+
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + 64 <= size; i += 64) {
+    uint64_t mask = tokenizer::avx2::tokenMask(begin + i) |
+                    (static_cast<uint64_t>(tokenizer::avx2::tokenMask(begin + i + 32)) << 32);
+    if (non_ascii) {
+      // The sign bits are the bytes >= 128.
+      auto high = [](const char* it) {
+        return static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it))));
+      };
+      mask |= high(begin + i) | (static_cast<uint64_t>(high(begin + i + 32)) << 32);
+    }
+    word_mask[i / 64] = mask;
+  }
+#endif
+  for (; i < size; ++i) {
+    char c = begin[i];
+    bool word = static_cast<unsigned char>(c) < 128 ? !tokenizer::isDelimiter(c) : non_ascii;
+    word_mask[i / 64] |= static_cast<uint64_t>(word) << (i % 64);
+  }
+}
+//---------------------------------------------------------------------------
+size_t TrigramExtractor::findBit(size_t pos, size_t size, bool set) const {
+  if (pos >= size) return size;
+
+  size_t index = pos / 64;
+  uint64_t bits = (set ? word_mask[index] : ~word_mask[index]) & (~0ull << (pos % 64));
+  while (bits == 0) {
+    if (++index == word_mask.size()) return size;
+    bits = set ? word_mask[index] : ~word_mask[index];
+  }
+  return std::min(size, index * 64 + std::countr_zero(bits));
+}
+//---------------------------------------------------------------------------
+}  // namespace trigramlib
@@ -0,0 +1,48 @@
+#ifndef TRIGRAM_EXTRACTOR_HPP
+#define TRIGRAM_EXTRACTOR_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+//---------------------------------------------------------------------------
+namespace trigramlib {
+//---------------------------------------------------------------------------
+/**
+ * Extracts all trigrams of a text at once, as raw Trigram values.
+ *
+ * Produces the same trigrams in the same order as TrigramParser, which remains the
+ * reference implementation. The text is lower-cased and classified 32 bytes at a
+ * time into a word bitmap. Word boundaries are then found with bit scans, and every
+ * trigram is a single unaligned 4-byte load. Meant to be reused by a single thread.
+ */
+class TrigramExtractor {
+ public:
+  /// Constructor. Bytes >= 128 are word characters if non_ascii is set, see foldUnicode.
+  explicit TrigramExtractor(bool non_ascii = false);
+  /// @brief Replaces the content of out by the raw trigram values of [begin, end).
+  /// @param begin The begin of the text.
+  /// @param end The end of the text.
+  /// @param out Receives the raw trigram values in text order.
+  /// @param words If set, receives the lower-cased words of the text. They point into the
+  /// extractor and remain valid until the next call.
+  void extract(const char* begin, const char* end, std::vector<uint32_t>& out,
+               std::vector<std::string_view>* words = nullptr);
+
+ private:
+  /// Sets bit i of word_mask if byte i of the text is a word character.
+  void classify(const char* begin, size_t size);
+  /// The first position >= pos whose word_mask bit equals set, or size.
+  [[nodiscard]] size_t findBit(size_t pos, size_t size, bool set) const;
+
+  /// Whether bytes >= 128 are word characters.
+  bool non_ascii;
+  /// The lower-cased text, padded by one byte for the 4-byte loads.
+  std::string lowered;
+  /// One bit per byte of the text, set for word characters.
+  std::vector<uint64_t> word_mask;
+};
+//---------------------------------------------------------------------------
+}  // namespace trigramlib
+//---------------------------------------------------------------------------
+#endif  // TRIGRAM_EXTRACTOR_HPP
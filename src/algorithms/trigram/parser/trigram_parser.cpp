@@ -1,28 +1,59 @@
 #include <cassert>
+#include <cctype>
 //---------------------------------------------------------------------------
 #include "trigram_parser.hpp"
+#include "tokenizer/utf8.hpp"
 //---------------------------------------------------------------------------
 namespace trigramlib {
 //---------------------------------------------------------------------------
-TrigramParser::TrigramParser(const char* begin, const char* end)
-    : end(end), it(begin), word_begin(begin), trigram_begin(begin), offset(0) {}
+namespace {
+//---------------------------------------------------------------------------
+/// Lower-cases an ASCII letter, leaves all other bytes alone.
+char toLower(char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); }
+//---------------------------------------------------------------------------
+}  // namespace
+//---------------------------------------------------------------------------
+void foldUnicode(const char* begin, const char* end, std::string& out) {
+  out.clear();
+  for (const char* it = begin; it < end;) {
+    if (static_cast<unsigned char>(*it) < 0x80) {
+      out.push_back(*it++);
+      continue;
+    }
+    char32_t cp = tokenizer::utf8::decode(it, end);
+    if (!tokenizer::utf8::isWordChar(cp)) {
+      out.push_back(' ');
+      continue;
+    }
+    // Unlike a hash, the encoding keeps distinct characters apart.
+    tokenizer::utf8::encode(tokenizer::utf8::foldCase(cp), out);
+  }
+}
+//---------------------------------------------------------------------------
+TrigramParser::TrigramParser(const char* begin, const char* end, bool non_ascii)
+    : non_ascii(non_ascii),
+      end(end),
+      it(begin),
+      word_begin(begin),
+      trigram_begin(begin),
+      offset(0) {}
 //---------------------------------------------------------------------------
 bool TrigramParser::hasNext() {
   bool found = false;
 
   while (it < end) {
     auto c = static_cast<unsigned char>(*it);
-    if (c < 128 && kWhiteList[c]) {
+    if (c < 128 ? kWhiteList[c] : non_ascii) {
       if (it - trigram_begin >= 2) {
-        // three consecutive white-listed ASCII characters
+        // three consecutive white-listed characters
         assert(it - trigram_begin == 2);
         assert(trigram_begin >= word_begin);
 
         found = true;
 
-        trigram[0] = static_cast<char>(std::tolower(*trigram_begin));
-        trigram[1] = static_cast<char>(std::tolower(*(trigram_begin + 1)));
-        trigram[2] = static_cast<char>(std::tolower(*(trigram_begin + 2)));
+        trigram[0] = toLower(*trigram_begin);
+        trigram[1] = toLower(*(trigram_begin + 1));
+        trigram[2] = toLower(*(trigram_begin + 2));
         offset = static_cast<uint8_t>(trigram_begin - word_begin);
 
         ++trigram_begin;
@@ -32,8 +63,8 @@ bool TrigramParser::hasNext() {
         // stand-alone two-character "trigram"
         found = true;
 
-        trigram[0] = static_cast<char>(std::tolower(*word_begin));
-        trigram[1] = static_cast<char>(std::tolower(*(word_begin + 1)));
+        trigram[0] = toLower(*word_begin);
+        trigram[1] = toLower(*(word_begin + 1));
         trigram[2] = '\0';
         offset = 0;
       }
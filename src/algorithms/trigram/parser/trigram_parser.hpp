@@ -2,6 +2,7 @@
 #define TRIGRAM_PARSER_H
 //---------------------------------------------------------------------------
 #include <cstdint>
+#include <string>
 //---------------------------------------------------------------------------
 #include "algorithms/trigram/models/trigram.hpp"
 //---------------------------------------------------------------------------
@@ -28,10 +29,20 @@ constexpr std::array<bool, 128> generateWhitelist() {
 //---------------------------------------------------------------------------
 constexpr uint32_t kNumPossibleTrigrams = 41 * 41 * 41 * kMaxWordOffset;
 //---------------------------------------------------------------------------
+/// @brief Maps UTF-8 text onto the bytes indexed by a non-ASCII TrigramParser.
+/// ASCII bytes are kept, non-ASCII word characters become the UTF-8 encoding of their
+/// case-folded code point, and all other characters become spaces. The trigrams are taken
+/// over bytes, so a non-ASCII character spans several of them, but distinct characters
+/// never share one.
+/// @param begin The begin of the text.
+/// @param end The end of the text.
+/// @param out Receives the mapped text.
+void foldUnicode(const char* begin, const char* end, std::string& out);
+//---------------------------------------------------------------------------
 class TrigramParser {
  public:
-  /// Constructor
-  TrigramParser(const char* begin, const char* end);
+  /// Constructor. Bytes >= 128 are word characters if non_ascii is set, see foldUnicode.
+  TrigramParser(const char* begin, const char* end, bool non_ascii = false);
   /// Whether there is another Trigram.
   bool hasNext();
   /// Get the next trigram.
@@ -41,6 +52,8 @@ class TrigramParser {
   /// A whitelist of ASCII characters allowed in the trigrams.
   static constexpr std::array<bool, 128> kWhiteList = generateWhitelist();
 
+  /// Whether bytes >= 128 are word characters.
+  bool non_ascii;
   /// The end of the text to parse.
   const char* end;
   /// The text iterator.
@@ -1,95 +1,207 @@
-#include <cassert>
+#include <algorithm>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_map>
 //---------------------------------------------------------------------------
 #include "algorithms/trigram/models/trigram.hpp"
+#include "data-structures/term_counter.hpp"
+#include "data-structures/top_k.hpp"
+#include "tokenizer/simd_scan.hpp"
 #include "trigram_index_engine.hpp"
 #include "utils.hpp"
 //---------------------------------------------------------------------------
+TrigramIndexEngine::TrigramIndexEngine(bool unicode, uint32_t fuzzy_distance)
+    : unicode(unicode), fuzzy_distance(fuzzy_distance) {}
+//---------------------------------------------------------------------------
 void TrigramIndexEngine::indexDocuments(std::string& data_path) {
+  // Document IDs are mostly consecutive, so every thread can write its lengths directly.
+  // The lengths of larger IDs are collected per thread and stored afterwards.
+  uint64_t num_documents = DocumentIterator::countDocuments(data_path);
+  doc_to_length.assign(num_documents + 1, 0);
+
+  std::unique_ptr<Vocabulary> vocabulary;
+  if (fuzzy_distance > 0) {
+    vocabulary = std::make_unique<Vocabulary>(std::max<uint64_t>(num_documents, 1 << 16));
+  }
+
+  std::unique_ptr<TrigramRuns> runs;
+  if (memory_budget > 0) runs = std::make_unique<TrigramRuns>(spill_directory);
+
+  index.reopen();
   DocumentIterator doc_it(data_path);
   std::atomic<uint64_t> total_trigram_count = 0;
 
   auto thread_count = std::thread::hardware_concurrency();
   std::vector<std::thread> threads;
-  std::vector<std::unordered_map<DocumentID, uint32_t>> local_doc_to_lengths(thread_count);
+  std::vector<std::vector<std::pair<DocumentID, uint32_t>>> sparse_lengths(thread_count);
 
   // diverge
   for (size_t i = 0; i < thread_count; ++i) {
-    threads.push_back(
-        std::thread([this, &doc_it, &total_trigram_count, &local_doc_to_lengths, i]() {
-          total_trigram_count += consumeDocuments(doc_it, local_doc_to_lengths[i]);
+    threads.push_back(std::thread(
+        [this, &doc_it, &total_trigram_count, &vocabulary, &runs, &sparse_lengths, i]() {
+          total_trigram_count +=
+              consumeDocuments(doc_it, vocabulary.get(), runs.get(), &sparse_lengths[i]);
         }));
   }
   for (auto& t : threads) {
     t.join();
   }
-
+  for (const auto& lengths : sparse_lengths) {
+    for (auto [doc_id, length] : lengths) {
+      if (doc_id >= doc_to_length.size()) doc_to_length.resize(doc_id + 1);
+      doc_to_length[doc_id] = length;
+    }
+  }
   avg_doc_length = static_cast<double>(total_trigram_count) / static_cast<double>(doc_count);
-
-  // merge
-  merge(local_doc_to_lengths);
-
-  // compactify
   uint32_t stop_share =
       std::clamp(static_cast<uint32_t>(doc_count / (avg_doc_length + 1)), 2U, 10U);
+  // Without spilled runs all occurences are known, so the chunks of the too frequent
+  // trigrams are freed before the fuzzy matcher is built
+  if (!runs) index.compactify(doc_count / stop_share);
+
+  // merge the spilled runs, every occurence list is allocated once
+  spill_statistics = {};
+  if (runs) {
+    runs->merge([this](uint32_t raw_trigram, const std::vector<trigramlib::DocFreq>& occurences) {
+      index.insertAll(trigramlib::Trigram(raw_trigram), occurences);
+    });
+    spill_statistics = runs->getStatistics();
+    runs.reset();
+  }
+
+  if (vocabulary) {
+    std::vector<std::pair<std::string, uint32_t>> words;
+    for (auto& [word, frequency] : *vocabulary) {
+      words.emplace_back(std::move(word), frequency);
+    }
+    vocabulary.reset();
+    fuzzy_matcher.build(std::move(words));
+  }
+
+  // compactify, then pack the occurences for reading
   index.compactify(doc_count / stop_share);
+  index.finalize();
+  deleted.resize(0);
+  deleted.resize(doc_to_length.size());
+  deleted_length = 0;
+  markIndexChanged();
+}
+//---------------------------------------------------------------------------
+bool TrigramIndexEngine::deleteDocument(DocumentID doc_id) {
+  // Gaps in the document ids have no trigrams
+  if (doc_id >= doc_to_length.size() || doc_to_length[doc_id] == 0 || !deleted.erase(doc_id)) {
+    return false;
+  }
+  deleted_length += doc_to_length[doc_id];
+  markIndexChanged();
+  return true;
+}
+//---------------------------------------------------------------------------
+void TrigramIndexEngine::updateDocuments(const std::string& data_path) {
+  std::vector<DocumentID> doc_ids;
+  {
+    DocumentIterator doc_it(data_path);
+    for (auto docs = doc_it.next(); !docs.empty(); docs = doc_it.next()) {
+      for (const auto& doc : docs) doc_ids.push_back(doc.getId());
+    }
+  }
+  if (doc_ids.empty()) return;
+  uint64_t num_slots = doc_to_length.size();
+  DocumentID max_doc_id = *std::max_element(doc_ids.begin(), doc_ids.end());
+  if (max_doc_id >= num_slots) {
+    doc_to_length.resize(max_doc_id + 1);
+    deleted.resize(max_doc_id + 1);
+  }
+
+  // Drop the occurences of the old versions, only the indexed ones are counted
+  uint32_t num_replaced = 0;
+  for (DocumentID doc_id : doc_ids) {
+    num_replaced += doc_id < num_slots && doc_to_length[doc_id] != 0;
+    deleteDocument(doc_id);
+  }
+  compact();
+  for (DocumentID doc_id : doc_ids) {
+    if (deleted.revive(doc_id)) deleted_length -= doc_to_length[doc_id];
+  }
+
+  index.reopen();
+  DocumentIterator doc_it(data_path);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < std::thread::hardware_concurrency(); ++i) {
+    threads.emplace_back([this, &doc_it]() { consumeDocuments(doc_it, nullptr); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  index.finalize();
+  doc_count -= num_replaced;
+
+  uint64_t total_trigram_count = 0;
+  for (uint32_t length : doc_to_length) total_trigram_count += length;
+  avg_doc_length = static_cast<double>(total_trigram_count) / static_cast<double>(doc_count);
+  markIndexChanged();
+}
+//---------------------------------------------------------------------------
+void TrigramIndexEngine::setMemoryBudget(uint64_t budget_bytes,
+                                         const std::string& spill_directory) {
+  memory_budget = budget_bytes;
+  this->spill_directory = spill_directory;
+}
+//---------------------------------------------------------------------------
+const SpillStatistics& TrigramIndexEngine::getSpillStatistics() const { return spill_statistics; }
+//---------------------------------------------------------------------------
+void TrigramIndexEngine::compact() {
+  index.removeIf(
+      [this](const trigramlib::DocFreq& occurence) { return deleted.contains(occurence.doc_id); });
+  markIndexChanged();
 }
 //---------------------------------------------------------------------------
 std::vector<std::pair<DocumentID, double>> TrigramIndexEngine::search(
     const std::string& query, const scoring::ScoringFunction& score_func, uint32_t num_results) {
-  std::unordered_map<DocumentID, double> doc_to_score;
+  // Reused by all queries of this thread
+  thread_local std::unordered_map<DocumentID, double> doc_to_score;
+  doc_to_score.clear();
 
   const char* begin = query.c_str();
   const char* end = query.c_str() + query.size();
-  trigramlib::TrigramParser trigram_parser(begin, end);
+  std::string folded;
+  prepareText(begin, end, folded);
+  std::string corrected;
+  if (fuzzy_distance > 0) {
+    correctQuery(begin, end, corrected);
+    begin = corrected.data();
+    end = corrected.data() + corrected.size();
+  }
+  thread_local std::vector<uint32_t> trigrams;
+  trigramlib::TrigramExtractor(unicode).extract(begin, end, trigrams);
 
   // The query's trigrams found in the index
-  std::vector<std::vector<trigramlib::DocFreq>*> trigram_results;
-
-  // Parse the data
-  while (trigram_parser.hasNext()) {
-    trigramlib::Trigram trigram = trigram_parser.next();
-    // Lookup the trigram in the index
-    trigram_results.emplace_back(index.lookup(trigram));
+  thread_local std::vector<std::span<const trigramlib::DocFreq>> trigram_results;
+  trigram_results.clear();
+  for (uint32_t raw_trigram : trigrams) {
+    trigram_results.emplace_back(index.lookup(trigramlib::Trigram(raw_trigram)));
   }
 
   // Aggregate and normalize the scores
   for (const auto& result : trigram_results) {
-    if (result == nullptr) continue;
-
-    for (const auto& match : *result) {
+    for (const auto& match : result) {
       doc_to_score[match.doc_id] +=
           score_func.score({doc_to_length[match.doc_id]},
-                           {match.freq, static_cast<uint32_t>(result->size())}) /
+                           {match.freq, static_cast<uint32_t>(result.size())}) /
           static_cast<double>(trigram_results.size());
     }
   }
 
-  // Build MinHeap on score
-  std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>,
-                      std::greater<>>
-      ordered_docs;
-
+  // Select the top results
+  TopK top_docs(num_results);
   for (const auto& [doc_id, score] : doc_to_score) {
-    if (ordered_docs.size() < num_results) {
-      ordered_docs.emplace(score, doc_id);
-    } else if (score > ordered_docs.top().first) {
-      ordered_docs.pop();
-      ordered_docs.emplace(score, doc_id);
-    }
-  }
-
-  // Extract top results
-  std::vector<std::pair<DocumentID, double>> results{ordered_docs.size()};
-  for (int i = static_cast<int>(ordered_docs.size()) - 1; i >= 0; i--) {
-    results[i] = {ordered_docs.top().second, ordered_docs.top().first};
-    ordered_docs.pop();
+    if (!deleted.contains(doc_id)) top_docs.push(score, doc_id);
   }
-
-  return results;
+  return top_docs.extract();
 }
 //---------------------------------------------------------------------------
 /**
@@ -150,8 +262,13 @@ void TrigramIndexEngine::load(const std::string& path) {
     doc_to_length[doc_id] = length;
   }
 
+  deleted.resize(0);
+  deleted.resize(doc_to_length.size());
+  deleted_length = 0;
+
   // load index
   index.load(it, end);
+  markIndexChanged();
 }
 //---------------------------------------------------------------------------
 uint64_t TrigramIndexEngine::footprint_capacity() {
@@ -161,9 +278,11 @@ uint64_t TrigramIndexEngine::footprint_capacity() {
   size += sizeof(doc_count);
   size += sizeof(avg_doc_length);
   size += sizeof(doc_to_length) + doc_to_length.capacity() * sizeof(uint32_t);
+  size += deleted.footprint();
 
   // Index
   size += index.footprint_capacity();
+  size += fuzzy_matcher.footprint_capacity();
 
   return size;
 }
@@ -175,75 +294,139 @@ uint64_t TrigramIndexEngine::footprint_size() {
   size += sizeof(doc_count);
   size += sizeof(avg_doc_length);
   size += sizeof(doc_to_length) + doc_to_length.size() * sizeof(uint32_t);
+  size += deleted.footprint();
 
   // Index
   size += index.footprint_size();
+  size += fuzzy_matcher.footprint_size();
 
   return size;
 }
 //---------------------------------------------------------------------------
-void TrigramIndexEngine::merge(std::vector<std::unordered_map<DocumentID, uint32_t>>& maps) {
-  doc_to_length.resize(doc_count + 1);
-
-  auto thread_count = std::thread::hardware_concurrency();
-  assert(maps.size() == thread_count);
-
-  std::vector<std::thread> threads;
-  for (size_t i = 0; i < thread_count; ++i) {
-    threads.push_back(std::thread([this, &maps, i]() {
-      for (const auto& [doc_id, length] : maps[i]) {
-        doc_to_length[doc_id] = length;
-      }
-    }));
-  }
-
-  for (auto& t : threads) {
-    t.join();
-  }
-}
-//---------------------------------------------------------------------------
-uint64_t TrigramIndexEngine::consumeDocuments(
-    DocumentIterator& doc_it, std::unordered_map<DocumentID, uint32_t>& local_doc_to_length) {
+uint64_t TrigramIndexEngine::consumeDocuments(DocumentIterator& doc_it, Vocabulary* vocabulary,
+                                              TrigramRuns* runs,
+                                              std::vector<std::pair<DocumentID, uint32_t>>*
+                                                  sparse_lengths) {
   uint64_t local_trigram_count = 0;
   uint32_t local_doc_count = 0;
 
+  // The occurences of the next run and their approximate heap size
+  std::unordered_map<uint32_t, std::vector<trigramlib::DocFreq>> pending;
+  constexpr uint64_t kPendingNodeBytes =
+      sizeof(std::pair<const uint32_t, std::vector<trigramlib::DocFreq>>) + 2 * sizeof(void*);
+  uint64_t pending_bytes = 0;
+  uint64_t thread_budget =
+      std::max<uint64_t>(memory_budget / std::thread::hardware_concurrency(), 1);
+  auto spill = [&]() {
+    std::vector<TrigramRuns::Entry> entries;
+    entries.reserve(pending.size());
+    for (auto& [raw_trigram, occurences] : pending) {
+      entries.emplace_back(raw_trigram, std::move(occurences));
+    }
+    runs->write(entries);
+    pending = {};
+    pending_bytes = 0;
+  };
+
+  std::string folded;
+  trigramlib::TrigramExtractor extractor(unicode);
+  std::vector<uint32_t> trigrams;
+  std::vector<std::string_view> words;
+  TermCounter distinct_words;
+
   std::vector<Document> docs = doc_it.next();
   while (!docs.empty()) {
     for (const auto& doc : docs) {
-      uint32_t doc_length = 0;
-      // Count the number of occurences per trigram for the scoring.
-      // Note: Since the hash and equality function of the trigram do NOT
-      // differentiate word offset, which is wanted here, the trigram's
-      // raw value is used.
-      std::unordered_map<uint32_t, uint32_t> trigram_occurences;
-
       const char* begin = doc.getData();
       const char* end = doc.getData() + doc.getSize();
-      trigramlib::TrigramParser trigram_parser(begin, end);
-
-      // Parse the data
-      while (trigram_parser.hasNext()) {
-        ++trigram_occurences[trigram_parser.next().getRawValue()];
-        ++doc_length;
+      prepareText(begin, end, folded);
+      extractor.extract(begin, end, trigrams, vocabulary != nullptr ? &words : nullptr);
+      auto doc_length = static_cast<uint32_t>(trigrams.size());
+
+      if (vocabulary != nullptr) {
+        distinct_words.clear();
+        for (auto word : words) {
+          if (word.size() >= trigramlib::FuzzyMatcher::kMinWordLength &&
+              word.size() <= trigramlib::FuzzyMatcher::kMaxWordLength) {
+            distinct_words.add(word);
+          }
+        }
+        for (const auto& entry : distinct_words) {
+          vocabulary->updateOrInsert(entry.term, [](uint32_t& frequency) { ++frequency; }, 0U);
+        }
       }
 
+      // Count the number of occurences per trigram for the scoring by sorting the
+      // trigrams into runs.
+      // Note: Since the hash and equality function of the trigram do NOT
+      // differentiate word offset, which is wanted here, the trigram's
+      // raw value is used.
+      std::sort(trigrams.begin(), trigrams.end());
+
       // Insert into index
-      for (const auto& [raw_trigram, count] : trigram_occurences) {
-        index.insert(trigramlib::Trigram(raw_trigram), {doc.getId(), count});
+      for (size_t run_begin = 0, run_end; run_begin < trigrams.size(); run_begin = run_end) {
+        run_end = run_begin + 1;
+        while (run_end < trigrams.size() && trigrams[run_end] == trigrams[run_begin]) ++run_end;
+        trigramlib::DocFreq occurence{doc.getId(), static_cast<uint32_t>(run_end - run_begin)};
+        if (runs == nullptr) {
+          index.insert(trigramlib::Trigram(trigrams[run_begin]), occurence);
+          continue;
+        }
+        auto [it, inserted] = pending.try_emplace(trigrams[run_begin]);
+        size_t capacity = it->second.capacity();
+        it->second.push_back(occurence);
+        pending_bytes += (it->second.capacity() - capacity) * sizeof(trigramlib::DocFreq);
+        if (inserted) pending_bytes += kPendingNodeBytes;
       }
 
       // Update statistics
       local_trigram_count += doc_length;
-      local_doc_to_length[doc.getId()] = doc_length;
+      if (doc.getId() < doc_to_length.size()) {
+        doc_to_length[doc.getId()] = doc_length;
+      } else if (sparse_lengths != nullptr) {
+        sparse_lengths->emplace_back(doc.getId(), doc_length);
+      } else {
+        throw std::out_of_range("Document ID " + std::to_string(doc.getId()) + " out of range");
+      }
       ++local_doc_count;
     }
+    if (runs != nullptr && pending_bytes >= thread_budget) spill();
     docs = doc_it.next();
   }
+  if (runs != nullptr && !pending.empty()) spill();
   doc_count += local_doc_count;
 
   return local_trigram_count;
 }
 //---------------------------------------------------------------------------
-uint32_t TrigramIndexEngine::getDocumentCount() { return doc_count; }
+void TrigramIndexEngine::correctQuery(const char* begin, const char* end,
+                                      std::string& out) const {
+  trigramlib::TrigramExtractor extractor(unicode);
+  std::vector<uint32_t> trigrams;
+  std::vector<std::string_view> words;
+  extractor.extract(begin, end, trigrams, &words);
+
+  out.clear();
+  for (auto word : words) {
+    if (!out.empty()) out.push_back(' ');
+    out.append(fuzzy_matcher.correct(word, fuzzy_distance));
+  }
+}
+//---------------------------------------------------------------------------
+void TrigramIndexEngine::prepareText(const char*& begin, const char*& end,
+                                     std::string& buffer) const {
+  if (!unicode || tokenizer::isAscii(begin, end - begin)) return;
+
+  trigramlib::foldUnicode(begin, end, buffer);
+  begin = buffer.data();
+  end = buffer.data() + buffer.size();
+}
+//---------------------------------------------------------------------------
+uint32_t TrigramIndexEngine::getDocumentCount() { return doc_count - deleted.count(); }
 //---------------------------------------------------------------------------
-double TrigramIndexEngine::getAvgDocumentLength() { return avg_doc_length; }
\ No newline at end of file
+double TrigramIndexEngine::getAvgDocumentLength() {
+  if (deleted.count() == 0) return avg_doc_length;
+  // Take the deleted documents out of the average
+  double num_trigrams = avg_doc_length * doc_count - static_cast<double>(deleted_length);
+  return getDocumentCount() == 0 ? 0.0 : num_trigrams / getDocumentCount();
+}
\ No newline at end of file
@@ -1,14 +1,22 @@
 #ifndef TRIGRAM_INDEX_ENGINE_HPP
 #define TRIGRAM_INDEX_ENGINE_HPP
 //---------------------------------------------------------------------------
+#include "algorithms/trigram/fuzzy/fuzzy_matcher.hpp"
 #include "algorithms/trigram/models/trigram.hpp"
+#include "algorithms/trigram/parser/trigram_extractor.hpp"
 #include "algorithms/trigram/parser/trigram_parser.hpp"
+#include "data-structures/parallel_hash_table.hpp"
+#include "data-structures/sorted_runs.hpp"
+#include "data-structures/tombstones.hpp"
 #include "documents/document_iterator.hpp"
 #include "fts_engine.hpp"
 #include "index/parallel_hash_index.hpp"
 //---------------------------------------------------------------------------
 class TrigramIndexEngine : public FullTextSearchEngine {
  public:
+  /// Constructor. Indexes non-ASCII letters if unicode is set, see trigramlib::foldUnicode.
+  /// Corrects query words within fuzzy_distance edits of a known word, 0 disables it.
+  explicit TrigramIndexEngine(bool unicode = false, uint32_t fuzzy_distance = 0);
   /// Build the index.
   void indexDocuments(std::string &data_path) override;
   /// Search for string.
@@ -24,23 +32,60 @@ class TrigramIndexEngine : public FullTextSearchEngine {
   /// Determines the used memory footprint of the engine in bytes.
   uint64_t footprint_size() override;
 
+  /// Delete a document, false if it isn't indexed, has no trigrams or is already deleted.
+  /// Queries skip it right away, its occurences stay until compact. May run concurrently
+  /// with search.
+  bool deleteDocument(DocumentID doc_id);
+  /// Replace the indexed versions of the documents of a Parquet file or directory and add
+  /// the new ones. Compacts the index first, so updates should be batched. New words
+  /// aren't added to the vocabulary of the fuzzy search.
+  void updateDocuments(const std::string &data_path);
+  /// Remove the occurences of deleted documents.
+  void compact();
+  /// Bound the memory of the occurences collected by the next indexDocuments to about
+  /// budget_bytes. Beyond it, they are spilled as sorted runs below spill_directory and
+  /// merged into the index at the end. 0 builds in memory.
+  void setMemoryBudget(uint64_t budget_bytes, const std::string &spill_directory);
+  /// Get what the last indexDocuments spilled to disk.
+  const SpillStatistics &getSpillStatistics() const;
+
   /// Get the number of documents.
   uint32_t getDocumentCount() override;
   /// Get the average length of a document.
   double getAvgDocumentLength() override;
 
  private:
-  /// @brief Merges given doc_to_length maps into one.
-  /// To be precise, merges the given maps into the doc_to_length vector.
-  /// @param maps The maps to be merged.
-  void merge(std::vector<std::unordered_map<DocumentID, uint32_t>> &maps);
-  /// @brief Consumes documents and writes trigrams into the index.
+  /// The document frequency per word, collected for the fuzzy matcher.
+  using Vocabulary = ParallelHashTable<std::string, uint32_t>;
+  /// The occurences spilled by raw trigram.
+  using TrigramRuns = SortedRuns<uint32_t, trigramlib::DocFreq>;
+
+  /// @brief Consumes documents and writes trigrams and document lengths into the index.
   /// @param doc_it The iterator to consume the documents from.
-  /// @param local_doc_to_length The index to store the number of trigrams per document.
+  /// @param vocabulary Receives the documents' words, if set.
+  /// @param runs Receives the occurences in runs within the memory budget instead of the
+  /// index, if set.
+  /// @param sparse_lengths Receives the lengths of the documents with IDs beyond
+  /// doc_to_length, if set. Such IDs throw std::out_of_range otherwise.
   /// @return The total number of found trigrams.
-  uint64_t consumeDocuments(DocumentIterator &doc_it,
-                            std::unordered_map<DocumentID, uint32_t> &local_doc_to_length);
+  uint64_t consumeDocuments(DocumentIterator &doc_it, Vocabulary *vocabulary,
+                            TrigramRuns *runs = nullptr,
+                            std::vector<std::pair<DocumentID, uint32_t>> *sparse_lengths = nullptr);
+  /// @brief Replaces every misspelled word of [begin, end) by its closest known word.
+  /// @param begin The begin of the prepared query text.
+  /// @param end The end of the prepared query text.
+  /// @param out Receives the corrected words, separated by spaces.
+  void correctQuery(const char *begin, const char *end, std::string &out) const;
+  /// @brief Sets [begin, end) to the text the trigram parser consumes.
+  /// Non-ASCII text is mapped into buffer in unicode mode.
+  void prepareText(const char *&begin, const char *&end, std::string &buffer) const;
 
+  /// Whether non-ASCII letters are indexed.
+  bool unicode;
+  /// The maximum edit distance of corrected query words, 0 if disabled.
+  uint32_t fuzzy_distance;
+  /// The vocabulary for the fuzzy search.
+  trigramlib::FuzzyMatcher fuzzy_matcher;
   /// The underlying index.
   trigramlib::ParallelHashIndex<trigramlib::kNumPossibleTrigrams, trigramlib::kMaxWordOffset> index;
   /// The number of indexed documents.
@@ -51,6 +96,16 @@ class TrigramIndexEngine : public FullTextSearchEngine {
   std::vector<uint32_t> doc_to_length;
   /// The average document length in trigrams.
   double avg_doc_length;
+  /// The deleted documents.
+  Tombstones deleted;
+  /// The number of trigrams of the deleted documents.
+  std::atomic<uint64_t> deleted_length = 0;
+  /// The maximum number of bytes of occurences collected before spilling, 0 for no limit.
+  uint64_t memory_budget = 0;
+  /// The directory below which the runs are spilled.
+  std::string spill_directory;
+  /// What the last indexDocuments spilled to disk.
+  SpillStatistics spill_statistics;
 };
 //---------------------------------------------------------------------------
 #endif  // TRIGRAM_INDEX_ENGINE_HPP
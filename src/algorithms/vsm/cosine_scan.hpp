@@ -0,0 +1,98 @@
+#ifndef COSINE_SCAN_HPP
+#define COSINE_SCAN_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "data-structures/top_k.hpp"
+#include "fts_engine.hpp"
+
+namespace vsm {
+
+/**
+ * One posting at a time reference implementations of the query kernels of the
+ * VectorSpaceModelEngine. The vectorized versions below must produce exactly the same results.
+ */
+namespace scalar {
+
+/// Adds query_weight * weights[i] to scores[docs[i]] for all n postings.
+inline void accumulate(const DocumentID *docs, const float *weights, size_t n, float query_weight,
+                       float *scores) {
+  for (size_t i = 0; i < n; ++i) {
+    scores[docs[i]] += query_weight * weights[i];
+  }
+}
+
+/// Selects the num_results highest positive scores, in descending order.
+inline std::vector<std::pair<DocumentID, double>> topK(const std::vector<float> &scores,
+                                                       uint32_t num_results) {
+  TopK results(num_results);
+  for (size_t i = 0; i < scores.size(); ++i) {
+    if (scores[i] > 0.0f) results.push(scores[i], static_cast<DocumentID>(i));
+  }
+  return results.extract();
+}
+
+}  // namespace scalar
+
+/// Adds query_weight * weights[i] to scores[docs[i]] for all n postings.
+inline void accumulate(const DocumentID *docs, const float *weights, size_t n, float query_weight,
+                       float *scores) {
+  size_t i = 0;
+#ifdef __AVX2__
+  // AVX2 has no scatter, so only the products are computed eight at a time.
+  alignas(32) float products[8];
+  __m256 factor = _mm256_set1_ps(query_weight);
+  for (; i + 8 <= n; i += 8) {
+    _mm256_store_ps(products, _mm256_mul_ps(factor, _mm256_loadu_ps(weights + i)));
+    for (size_t j = 0; j < 8; ++j) {
+      scores[docs[i + j]] += products[j];
+    }
+  }
+#endif
+  scalar::accumulate(docs + i, weights + i, n - i, query_weight, scores);
+}
+
+/// Selects the num_results highest positive scores, in descending order.
+inline std::vector<std::pair<DocumentID, double>> topK(const std::vector<float> &scores,
+                                                       uint32_t num_results) {
+  TopK results(num_results);
+  if (num_results == 0) return {};
+
+  // Only scores above the threshold can enter the heap.
+  float threshold = 0.0f;
+  auto offer = [&](uint32_t doc_id) {
+    float score = scores[doc_id];
+    if (score <= threshold) return;
+    results.push(score, doc_id);
+    if (results.full()) threshold = static_cast<float>(results.threshold());
+  };
+
+  size_t i = 0;
+#ifdef __AVX2__
+  // Most documents score zero or below the threshold, so eight of them are skipped at once.
+  for (; i + 8 <= scores.size(); i += 8) {
+    __m256 above = _mm256_cmp_ps(_mm256_loadu_ps(scores.data() + i), _mm256_set1_ps(threshold),
+                                 _CMP_GT_OQ);
+    for (auto mask = static_cast<uint32_t>(_mm256_movemask_ps(above)); mask != 0;
+         mask &= mask - 1) {
+      offer(static_cast<uint32_t>(i + std::countr_zero(mask)));
+    }
+  }
+#endif
+  for (; i < scores.size(); ++i) {
+    offer(static_cast<uint32_t>(i));
+  }
+  return results.extract();
+}
+
+}  // namespace vsm
+
+#endif  // COSINE_SCAN_HPP
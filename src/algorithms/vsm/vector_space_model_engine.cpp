@@ -2,32 +2,217 @@
 
 #include "vector_space_model_engine.hpp"
 
-#include <stdexcept>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <string>
 
+#include "cosine_scan.hpp"
+#include "data-structures/term_counter.hpp"
+#include "documents/document_iterator.hpp"
+#include "tokenizer/batch_tokenizer.hpp"
+
+namespace {
+
+constexpr uint32_t kNoTermId = std::numeric_limits<uint32_t>::max();
+
+/// The weight of a term occurring frequency times.
+float termWeight(uint32_t frequency, float idf) {
+  return (1.0f + std::log(static_cast<float>(frequency))) * idf;
+}
+
+}  // namespace
+
+VectorSpaceModelEngine::VectorSpaceModelEngine(bool use_stem_cache, bool unicode)
+    : stem_cache_(use_stem_cache ? std::make_unique<tokenizer::StemCache>() : nullptr),
+      unicode_(unicode) {}
+
 void VectorSpaceModelEngine::indexDocuments(std::string &data_path) {
-  throw std::runtime_error("indexDocuments method is not yet implemented.");
+  uint64_t num_documents = DocumentIterator::countDocuments(data_path);
+  term_ids_ = ParallelHashTable<std::string, uint32_t>{std::max<uint64_t>(num_documents, 1 << 16)};
+
+  DocumentIterator doc_it(data_path);
+  std::atomic<uint32_t> next_term_id = 0;
+  std::atomic<DocumentID> max_doc_id = 0;
+  std::atomic<uint64_t> total_tokens = 0;
+  std::atomic<uint32_t> doc_count = 0;
+  std::vector<std::vector<TermOccurrence>> occurrences(NUM_THREADS);
+
+  auto collect_terms = [&](size_t thread_id) {
+    tokenizer::BatchTokenizer tokenizer(true, true, stem_cache_.get(), unicode_);
+    tokenizer::TokenBatch tokens;
+    TermCounter term_counter;
+    auto &local_occurrences = occurrences[thread_id];
+    DocumentID local_max_doc_id = 0;
+
+    for (auto batch = doc_it.next(); !batch.empty(); batch = doc_it.next()) {
+      tokenizer.tokenize(batch, tokens);
+      for (size_t doc_index = 0; doc_index < batch.size(); ++doc_index) {
+        DocumentID doc_id = batch[doc_index].getId();
+        local_max_doc_id = std::max(local_max_doc_id, doc_id);
+        term_counter.clear();
+        for (uint32_t i = tokens.doc_offsets[doc_index]; i < tokens.doc_offsets[doc_index + 1];
+             ++i) {
+          term_counter.add(tokens.token(i));
+        }
+
+        for (const auto &[term, frequency] : term_counter) {
+          uint32_t term_id = kNoTermId;
+          auto assign_id = [&next_term_id, &term_id](uint32_t &id) {
+            if (id == kNoTermId) id = next_term_id++;
+            term_id = id;
+          };
+          term_ids_.updateOrInsert(term, assign_id, kNoTermId);
+          local_occurrences.push_back({term_id, doc_id, frequency});
+        }
+      }
+      total_tokens += tokens.size();
+      doc_count += static_cast<uint32_t>(batch.size());
+    }
+
+    DocumentID current_max_doc_id = max_doc_id.load();
+    while (current_max_doc_id < local_max_doc_id &&
+           !max_doc_id.compare_exchange_weak(current_max_doc_id, local_max_doc_id)) {
+      current_max_doc_id = max_doc_id.load();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < NUM_THREADS; i++) {
+    threads.emplace_back(collect_terms, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  doc_count_ = doc_count;
+  average_doc_length_ =
+      doc_count_ == 0 ? 0.0 : static_cast<double>(total_tokens) / static_cast<double>(doc_count_);
+  // The norms are indexed by document id, which may exceed the number of documents
+  doc_norms_.assign(std::max<uint64_t>(num_documents, max_doc_id) + 1, 0.0f);
+  term_offsets_.assign(next_term_id + 1, 0);
+  buildVectors(occurrences);
+  markIndexChanged();
+}
+
+void VectorSpaceModelEngine::buildVectors(std::vector<std::vector<TermOccurrence>> &occurrences) {
+  // Count the documents per term, the prefix sums are the row offsets.
+  size_t num_terms = term_offsets_.size() - 1;
+  for (const auto &local_occurrences : occurrences) {
+    for (const auto &occurrence : local_occurrences) {
+      ++term_offsets_[occurrence.term_id + 1];
+    }
+  }
+  term_idfs_.resize(num_terms);
+  for (size_t term_id = 0; term_id < num_terms; ++term_id) {
+    term_idfs_[term_id] =
+        static_cast<float>(scoring::idf(doc_count_, term_offsets_[term_id + 1]));
+    term_offsets_[term_id + 1] += term_offsets_[term_id];
+  }
+
+  // Scatter the weighted occurrences into their rows.
+  posting_docs_.resize(term_offsets_.back());
+  posting_weights_.resize(term_offsets_.back());
+  std::vector<uint64_t> cursors(term_offsets_.begin(), term_offsets_.end() - 1);
+  for (auto &local_occurrences : occurrences) {
+    for (const auto &[term_id, doc_id, frequency] : local_occurrences) {
+      uint64_t posting = cursors[term_id]++;
+      float weight = termWeight(frequency, term_idfs_[term_id]);
+      posting_docs_[posting] = doc_id;
+      posting_weights_[posting] = weight;
+      doc_norms_[doc_id] += weight * weight;
+    }
+    std::vector<TermOccurrence>().swap(local_occurrences);
+  }
+
+  // Normalize the document vectors.
+  for (auto &norm : doc_norms_) {
+    norm = std::sqrt(norm);
+  }
+  for (size_t posting = 0; posting < posting_docs_.size(); ++posting) {
+    posting_weights_[posting] /= doc_norms_[posting_docs_[posting]];
+  }
 }
 
 std::vector<std::pair<DocumentID, double>> VectorSpaceModelEngine::search(
     const std::string &query, const scoring::ScoringFunction &score_func, uint32_t num_results) {
-  throw std::runtime_error("search method is not yet implemented.");
+  // Tokenize the query like the documents
+  tokenizer::BatchTokenizer tokenizer(true, true, stem_cache_.get(), unicode_);
+  tokenizer::TokenBatch tokens;
+  tokenizer.append(query.data(), query.size(), tokens);
+  TermCounter term_counter;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    term_counter.add(tokens.token(i));
+  }
+
+  // Build the query vector
+  std::vector<std::pair<uint32_t, float>> query_terms;
+  float query_norm = 0.0f;
+  for (const auto &[term, frequency] : term_counter) {
+    const uint32_t *term_id = term_ids_.get(std::string(term));
+    if (term_id == nullptr) {
+      // This term doesn't appear in any document
+      continue;
+    }
+    float weight = termWeight(frequency, term_idfs_[*term_id]);
+    query_terms.emplace_back(*term_id, weight);
+    query_norm += weight * weight;
+  }
+  if (query_terms.empty()) {
+    return {};
+  }
+  query_norm = std::sqrt(query_norm);
+
+  // Accumulate the dot products term at a time
+  thread_local std::vector<float> scores;
+  scores.assign(doc_norms_.size(), 0.0f);
+  for (const auto &[term_id, weight] : query_terms) {
+    uint64_t begin = term_offsets_[term_id];
+    uint64_t end = term_offsets_[term_id + 1];
+    vsm::accumulate(posting_docs_.data() + begin, posting_weights_.data() + begin, end - begin,
+               weight / query_norm, scores.data());
+  }
+
+  return vsm::topK(scores, num_results);
+}
+
+std::string VectorSpaceModelEngine::normalizeQuery(const std::string &query) {
+  tokenizer::BatchTokenizer tokenizer(true, true, stem_cache_.get(), unicode_);
+  tokenizer::TokenBatch tokens;
+  tokenizer.append(query.data(), query.size(), tokens);
+  std::string normalized;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    normalized.append(tokens.token(i)).push_back(' ');
+  }
+  return normalized;
 }
 
 uint64_t VectorSpaceModelEngine::footprint_capacity() {
-  // TODO
-  return 0;
+  uint64_t size = term_ids_.footprint_capacity();
+  for (auto &[term, term_id] : term_ids_) {
+    size += term.capacity();
+  }
+  size += term_offsets_.capacity() * sizeof(uint64_t);
+  size += posting_docs_.capacity() * sizeof(DocumentID);
+  size += posting_weights_.capacity() * sizeof(float);
+  size += term_idfs_.capacity() * sizeof(float);
+  size += doc_norms_.capacity() * sizeof(float);
+  return size + sizeof(VectorSpaceModelEngine);
 }
 
 uint64_t VectorSpaceModelEngine::footprint_size() {
-  // TODO
-  return 0;
+  uint64_t size = term_ids_.footprint_size();
+  for (auto &[term, term_id] : term_ids_) {
+    size += term.size();
+  }
+  size += term_offsets_.size() * sizeof(uint64_t);
+  size += posting_docs_.size() * sizeof(DocumentID);
+  size += posting_weights_.size() * sizeof(float);
+  size += term_idfs_.size() * sizeof(float);
+  size += doc_norms_.size() * sizeof(float);
+  return size + sizeof(VectorSpaceModelEngine);
 }
 
-uint32_t VectorSpaceModelEngine::getDocumentCount() {
-  throw std::runtime_error("Method is not yet implemented.");
-}
+uint32_t VectorSpaceModelEngine::getDocumentCount() { return doc_count_; }
 
-double VectorSpaceModelEngine::getAvgDocumentLength() {
-  throw std::runtime_error("Method is not yet implemented.");
-}
+double VectorSpaceModelEngine::getAvgDocumentLength() { return average_doc_length_; }
@@ -5,10 +5,33 @@
 #ifndef VECTORSPACEMODELENGINE_HPP
 #define VECTORSPACEMODELENGINE_HPP
 
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data-structures/parallel_hash_table.hpp"
 #include "fts_engine.hpp"
+#include "tokenizer/stem_cache.hpp"
 
+/**
+ * Ranks documents by the cosine similarity of their tf-idf vectors.
+ *
+ * A term's weight in a document is (1 + ln tf) * idf. All document vectors are
+ * L2-normalized at build time, so the cosine of a query and a document is a plain
+ * dot product. The vectors are stored transposed in CSR form (one contiguous
+ * run of doc IDs and weights per term), so a query accumulates the scores one
+ * term at a time into a dense score array. Documents and queries are tokenized
+ * like in the InvertedIndexEngine.
+ *
+ * The scoring function passed to search is ignored, the ranking is always cosine.
+ */
 class VectorSpaceModelEngine : public FullTextSearchEngine {
  public:
+  /// Constructor. Memoizes stems of frequent surface forms if use_stem_cache is set.
+  /// Keeps and case-folds non-ASCII letters if unicode is set.
+  explicit VectorSpaceModelEngine(bool use_stem_cache = true, bool unicode = false);
+
   void indexDocuments(std::string &data_path) override;
 
   std::vector<std::pair<DocumentID, double>> search(const std::string &query,
@@ -23,7 +46,49 @@ class VectorSpaceModelEngine : public FullTextSearchEngine {
 
   double getAvgDocumentLength() override;
 
+  /// Returns the stemmed query tokens without stop words.
+  std::string normalizeQuery(const std::string &query) override;
+
  private:
+  /// One term of one document, collected before the CSR layout is built.
+  struct TermOccurrence {
+    uint32_t term_id;
+    DocumentID doc_id;
+    uint32_t frequency;
+  };
+
+  /// Transposes the collected occurrences into the weighted, normalized CSR layout.
+  void buildVectors(std::vector<std::vector<TermOccurrence>> &occurrences);
+
+  const uint64_t NUM_THREADS = std::thread::hardware_concurrency();
+
+  /// key is term, value is its id, i.e. its row in the CSR layout
+  ParallelHashTable<std::string, uint32_t> term_ids_{1};
+
+  /// the postings of term t are [term_offsets_[t], term_offsets_[t + 1])
+  std::vector<uint64_t> term_offsets_;
+
+  /// the document of every posting
+  std::vector<DocumentID> posting_docs_;
+
+  /// the weight of every posting, divided by the norm of its document
+  std::vector<float> posting_weights_;
+
+  /// key is term id, value is the term's inverse document frequency
+  std::vector<float> term_idfs_;
+
+  /// key is document id, value is the L2 norm of the document's unnormalized vector
+  std::vector<float> doc_norms_;
+
+  uint32_t doc_count_ = 0;
+
+  double average_doc_length_ = 0.0;
+
+  /// memoized stems shared by all tokenizers of this engine, nullptr if disabled
+  std::unique_ptr<tokenizer::StemCache> stem_cache_;
+
+  /// whether documents and queries are tokenized as UTF-8
+  bool unicode_;
 };
 
 #endif  // VECTORSPACEMODELENGINE_HPP
@@ -11,10 +11,29 @@ FTSOptions parseCommandLine(int argc, char** argv) {
   // clang-format off
   options.add_options()
     ("d,data", "Path to the directory containing all data", cxxopts::value<std::string>())
-    ("a,algorithm", "Algorithm (inverted/vsm/trigram)", cxxopts::value<std::string>())
+    ("a,algorithm", "Algorithm (inverted/segmented/vsm/trigram)", cxxopts::value<std::string>())
     ("s,scoring", "Scoring (tf-idf,bm25)", cxxopts::value<std::string>())
     ("b,benchmarking-mode", "Run in benchmark mode, no queries", cxxopts::value<bool>()->default_value("false"))
     ("n,num_results", "Number of results displayed per query", cxxopts::value<uint32_t>()->default_value("10"))
+    ("stem-cache", "Memoize the stems of frequent tokens (inverted/segmented/vsm)", cxxopts::value<bool>()->default_value("true"))
+    ("fuzzy", "Correct query words within this many edits of an indexed word, 0 disables (trigram)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("unicode", "Index non-ASCII letters with Unicode case folding (inverted/segmented/vsm/trigram)", cxxopts::value<bool>()->default_value("false"))
+    ("batch", "Run the queries of --queries on a thread pool and report QPS and latencies", cxxopts::value<bool>()->default_value("false"))
+    ("threads", "Number of worker threads of --batch, 0 uses all cores", cxxopts::value<uint32_t>()->default_value("0"))
+    ("query-threads", "Number of threads scoring one query with many postings (inverted)", cxxopts::value<uint32_t>()->default_value("1"))
+    ("result-cache", "Size of the query result cache in MiB, 0 disables it", cxxopts::value<uint32_t>()->default_value("0"))
+    ("score-cache", "Size of the posting score cache of hot terms in MiB, 0 disables it (inverted)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("precision", "Score accumulation: double, float or 8-bit quantized impacts (inverted)", cxxopts::value<std::string>()->default_value("double"))
+    ("impact-order", "Answer queries score-at-a-time from impact-ordered postings (inverted)", cxxopts::value<bool>()->default_value("false"))
+    ("posting-budget", "Maximum number of postings processed per query of --impact-order, 0 processes all", cxxopts::value<uint64_t>()->default_value("0"))
+    ("max-score", "Skip documents that can't reach the top results with MaxScore (inverted)", cxxopts::value<bool>()->default_value("false"))
+    ("prune", "Static pruning: none, term or document-centric keeping --prune-keep of the postings (inverted)", cxxopts::value<std::string>()->default_value("none"))
+    ("prune-keep", "Share of the postings of every term or document kept by --prune", cxxopts::value<double>()->default_value("0.5"))
+    ("max-df", "Drop the postings of terms in more than this share of the documents (inverted)", cxxopts::value<double>()->default_value("1.0"))
+    ("reorder-documents", "Renumber similar documents consecutively by MinHash after indexing (inverted)", cxxopts::value<bool>()->default_value("false"))
+    ("merge-factor", "Number of segments of similar size merged into one in the background (segmented)", cxxopts::value<uint32_t>()->default_value("4"))
+    ("build-memory", "Memory budget of the postings built at once in MiB, spilling sorted runs beyond it, 0 for no limit (inverted/trigram)", cxxopts::value<uint32_t>()->default_value("0"))
+    ("spill-dir", "Directory of the runs spilled by --build-memory, the temporary directory if empty", cxxopts::value<std::string>()->default_value(""))
     (
       "q,queries",
       "Optional: Specifies the path to a directory containing .txt files. Each file represents a single query. "\
@@ -36,6 +55,25 @@ FTSOptions parseCommandLine(int argc, char** argv) {
   opts.scoring = result["scoring"].as<std::string>();
   opts.num_results = result["num_results"].as<uint32_t>();
   opts.benchmarking_mode = result["benchmarking-mode"].as<bool>();
+  opts.stem_cache = result["stem-cache"].as<bool>();
+  opts.unicode = result["unicode"].as<bool>();
+  opts.fuzzy_distance = result["fuzzy"].as<uint32_t>();
+  opts.batch_mode = result["batch"].as<bool>();
+  opts.num_threads = result["threads"].as<uint32_t>();
+  opts.query_threads = result["query-threads"].as<uint32_t>();
+  opts.result_cache_mb = result["result-cache"].as<uint32_t>();
+  opts.score_cache_mb = result["score-cache"].as<uint32_t>();
+  opts.precision = result["precision"].as<std::string>();
+  opts.impact_order = result["impact-order"].as<bool>();
+  opts.posting_budget = result["posting-budget"].as<uint64_t>();
+  opts.max_score = result["max-score"].as<bool>();
+  opts.pruning = result["prune"].as<std::string>();
+  opts.prune_keep = result["prune-keep"].as<double>();
+  opts.max_df = result["max-df"].as<double>();
+  opts.reorder_documents = result["reorder-documents"].as<bool>();
+  opts.merge_factor = result["merge-factor"].as<uint32_t>();
+  opts.build_memory_mb = result["build-memory"].as<uint32_t>();
+  opts.spill_dir = result["spill-dir"].as<std::string>();
   if (result.count("queries")) {
     opts.queries_path = result["queries"].as<std::string>();
   }
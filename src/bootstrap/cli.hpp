@@ -13,6 +13,25 @@ struct FTSOptions {
   uint32_t num_results;
   std::string queries_path;
   bool benchmarking_mode;
+  bool stem_cache;
+  bool unicode;
+  uint32_t fuzzy_distance;
+  bool batch_mode;
+  uint32_t num_threads;
+  uint32_t query_threads;
+  uint32_t result_cache_mb;
+  uint32_t score_cache_mb;
+  std::string precision;
+  bool impact_order;
+  uint64_t posting_budget;
+  bool max_score;
+  std::string pruning;
+  double prune_keep;
+  double max_df;
+  bool reorder_documents;
+  uint32_t merge_factor;
+  uint32_t build_memory_mb;
+  std::string spill_dir;
 };
 //---------------------------------------------------------------------------
 FTSOptions parseCommandLine(int argc, char** argv);
@@ -0,0 +1,150 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+//---------------------------------------------------------------------------
+#include <sys/mman.h>
+//---------------------------------------------------------------------------
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "utils.hpp"
+//---------------------------------------------------------------------------
+/**
+ * A bump allocator for the many small objects of an index build, freed all at once.
+ *
+ * Hands out memory from large blocks, so an allocation is a pointer increment instead
+ * of a malloc, and the objects of a build end up densely packed. Deallocating a small
+ * object is a no-op, its memory is only returned by release or destruction. Objects of a
+ * page or more are mapped on their own and unmapped right away on deallocation, so a
+ * build hands its biggest buffers back to the system while copying them out. Threads are
+ * spread round-robin over shards of blocks, so concurrent builders rarely share a lock.
+ * Usable with std::pmr containers.
+ */
+class Arena : public std::pmr::memory_resource {
+ public:
+  /// Constructor.
+  explicit Arena(size_t block_size = 1 << 20) : block_size(roundToPages(block_size)) {}
+  /// Destructor.
+  ~Arena() override { release(); }
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// Frees all memory handed out.
+  void release() {
+    {
+      std::lock_guard lock(large_lock);
+      for (auto [memory, size] : large_objects) unmap(memory, size);
+      large_objects.clear();
+      large_reserved = 0;
+    }
+    for (auto& shard : shards) {
+      std::lock_guard lock(shard.lock);
+      for (void* block : shard.blocks) unmap(block, block_size);
+      shard.blocks.clear();
+      shard.cursor = 0;
+      shard.end = 0;
+    }
+  }
+
+  /// Get the number of bytes of all blocks and large objects.
+  [[nodiscard]] uint64_t footprint() const {
+    uint64_t size = large_reserved;
+    for (const auto& shard : shards) size += shard.blocks.size() * block_size;
+    return size;
+  }
+
+ private:
+  /// The number of shards, enough for the threads of a build.
+  static constexpr size_t kNumShards = 64;
+  /// The granularity of mappings.
+  static constexpr size_t kPageSize = 4096;
+
+  /// The blocks of the threads picking this shard.
+  struct alignas(64) Shard {
+    utils::SpinLock lock;
+    /// The next free byte of the current block, 0 if there is none.
+    uintptr_t cursor = 0;
+    /// The end of the current block.
+    uintptr_t end = 0;
+    std::vector<void*> blocks;
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    assert(alignment <= kPageSize);
+    // Large objects are mapped on their own, so the current block isn't wasted
+    if (isLarge(bytes)) {
+      size_t size = roundToPages(bytes);
+      void* memory = map(size);
+      std::lock_guard lock(large_lock);
+      large_objects.emplace(memory, size);
+      large_reserved += size;
+      return memory;
+    }
+
+    Shard& shard = shards[shardIndex()];
+    std::lock_guard lock(shard.lock);
+    uintptr_t aligned = align(shard.cursor, alignment);
+    if (shard.cursor == 0 || aligned + bytes > shard.end) {
+      shard.blocks.push_back(map(block_size));
+      shard.cursor = reinterpret_cast<uintptr_t>(shard.blocks.back());
+      shard.end = shard.cursor + block_size;
+      aligned = align(shard.cursor, alignment);
+    }
+    shard.cursor = aligned + bytes;
+    return reinterpret_cast<void*>(aligned);
+  }
+  void do_deallocate(void* memory, size_t bytes, size_t) override {
+    if (!isLarge(bytes)) return;
+    size_t size = roundToPages(bytes);
+    {
+      std::lock_guard lock(large_lock);
+      large_objects.erase(memory);
+      large_reserved -= size;
+    }
+    unmap(memory, size);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  /// Get the shard of the calling thread, the threads are spread round-robin.
+  static size_t shardIndex() {
+    static std::atomic<size_t> next_index = 0;
+    thread_local size_t index = next_index++ % kNumShards;
+    return index;
+  }
+  /// Whether an object is mapped on its own, which wastes less than half of its pages.
+  static bool isLarge(size_t bytes) { return bytes >= kPageSize; }
+  /// Rounds an address up to a multiple of alignment.
+  static uintptr_t align(uintptr_t address, size_t alignment) {
+    return (address + alignment - 1) & ~(alignment - 1);
+  }
+  static size_t roundToPages(size_t size) { return align(size, kPageSize); }
+  /// Maps size bytes of zeroed memory.
+  static void* map(size_t size) {
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) throw std::bad_alloc();
+    return memory;
+  }
+  static void unmap(void* memory, size_t size) { munmap(memory, size); }
+
+  /// The size of a block, a multiple of the page size.
+  size_t block_size;
+  /// The blocks by shard.
+  std::array<Shard, kNumShards> shards;
+  /// Guards the large objects.
+  utils::SpinLock large_lock;
+  /// The large objects not yet deallocated and their mapped sizes.
+  std::unordered_map<void*, size_t> large_objects;
+  /// The number of bytes of the large objects.
+  std::atomic<uint64_t> large_reserved = 0;
+};
+//---------------------------------------------------------------------------
+#endif  // ARENA_HPP
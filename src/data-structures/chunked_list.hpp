@@ -0,0 +1,113 @@
+#ifndef CHUNKED_LIST_HPP
+#define CHUNKED_LIST_HPP
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+//---------------------------------------------------------------------------
+/**
+ * An append-only list of postings stored in chunks from a memory resource.
+ *
+ * Unlike a growing std::vector, appending never copies the elements and leaves no
+ * discarded buffers behind, which matters when the resource is an Arena. Chunks double
+ * in size from kMinChunkBytes up to kMaxChunkBytes, so short lists stay small and long ones
+ * waste at most one partially filled chunk. Chunk sizes are powers of two, so the large
+ * ones fill whole pages. The list doesn't own its chunks, clear hands them back
+ * to the resource they came from. Not thread-safe.
+ */
+template <typename T>
+class ChunkedList {
+  static_assert(std::is_trivially_destructible_v<T>);
+
+ public:
+  /// The number of bytes of the first chunk.
+  static constexpr uint32_t kMinChunkBytes = 64;
+  /// The maximum number of bytes of a chunk.
+  static constexpr uint32_t kMaxChunkBytes = 1 << 18;
+
+  /// Appends an element, allocating a new chunk from resource if the last one is full.
+  void push_back(const T& value, std::pmr::memory_resource& resource) {
+    if (tail == nullptr || tail->size == capacity(tail)) addChunk(resource);
+    ::new (elements(tail) + tail->size) T(value);
+    ++tail->size;
+    ++count;
+  }
+
+  /// Get the number of elements.
+  [[nodiscard]] size_t size() const { return count; }
+  /// Whether there are no elements.
+  [[nodiscard]] bool empty() const { return count == 0; }
+
+  /// Copies the elements to out in the order they were added, get the end of the copies.
+  template <typename OutputIt>
+  OutputIt copyTo(OutputIt out) const {
+    for (const Chunk* chunk = head; chunk != nullptr; chunk = chunk->next) {
+      out = std::copy(elements(chunk), elements(chunk) + chunk->size, out);
+    }
+    return out;
+  }
+  /// Appends the elements to out in the order they were added.
+  void appendTo(std::vector<T>& out) const {
+    out.reserve(out.size() + count);
+    copyTo(std::back_inserter(out));
+  }
+
+  /// Removes the elements, deallocating their chunks from resource.
+  void clear(std::pmr::memory_resource& resource) {
+    while (head != nullptr) {
+      Chunk* next = head->next;
+      resource.deallocate(head, head->bytes, kAlignment);
+      head = next;
+    }
+    tail = nullptr;
+    count = 0;
+  }
+
+ private:
+  struct Chunk {
+    /// The next chunk, nullptr for the last one.
+    Chunk* next;
+    /// The number of elements stored.
+    uint32_t size;
+    /// The number of bytes of the chunk including this header.
+    uint32_t bytes;
+  };
+  /// The offset of the elements behind a chunk header.
+  static constexpr size_t kHeaderSize = (sizeof(Chunk) + alignof(T) - 1) / alignof(T) * alignof(T);
+  /// The alignment of a chunk.
+  static constexpr size_t kAlignment = std::max(alignof(Chunk), alignof(T));
+
+  static T* elements(Chunk* chunk) {
+    return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(chunk) + kHeaderSize);
+  }
+  static const T* elements(const Chunk* chunk) {
+    return reinterpret_cast<const T*>(reinterpret_cast<const std::byte*>(chunk) + kHeaderSize);
+  }
+
+  /// Get the number of elements that fit into a chunk.
+  static uint32_t capacity(const Chunk* chunk) {
+    return static_cast<uint32_t>((chunk->bytes - kHeaderSize) / sizeof(T));
+  }
+
+  void addChunk(std::pmr::memory_resource& resource) {
+    uint32_t bytes = tail == nullptr ? kMinChunkBytes : std::min(tail->bytes * 2, kMaxChunkBytes);
+    void* memory = resource.allocate(bytes, kAlignment);
+    auto* chunk = ::new (memory) Chunk{nullptr, 0, bytes};
+    (tail == nullptr ? head : tail->next) = chunk;
+    tail = chunk;
+  }
+
+  /// The first chunk, nullptr if there is none.
+  Chunk* head = nullptr;
+  /// The last chunk, nullptr if there is none.
+  Chunk* tail = nullptr;
+  /// The number of elements.
+  size_t count = 0;
+};
+//---------------------------------------------------------------------------
+#endif  // CHUNKED_LIST_HPP
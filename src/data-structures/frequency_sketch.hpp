@@ -0,0 +1,76 @@
+#ifndef FREQUENCY_SKETCH_HPP
+#define FREQUENCY_SKETCH_HPP
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "utils.hpp"
+//---------------------------------------------------------------------------
+/**
+ * Estimates how often keys occurred recently (the TinyLFU admission filter).
+ *
+ * A count-min sketch with four rows of saturating 8-bit counters. Once
+ * 10 * width keys were added all counters are halved, so the estimates follow
+ * the recent access distribution instead of the whole history. Estimates never
+ * undercount a key since the last halving, hash collisions can only inflate them.
+ */
+class FrequencySketch {
+ public:
+  /// Constructor. Rounds width, the number of counters per row, up to a power of two.
+  explicit FrequencySketch(size_t width = 1 << 14)
+      : counters(kRows * utils::nextPowerOf2(width), 0),
+        mask(utils::nextPowerOf2(width) - 1),
+        sample_size(10 * utils::nextPowerOf2(width)) {}
+
+  /// Counts one occurrence of given key.
+  void add(std::string_view key) {
+    auto slots = locate(key);
+    for (size_t row = 0; row < kRows; ++row) {
+      auto& counter = counters[slots[row]];
+      if (counter != UINT8_MAX) ++counter;
+    }
+    if (++additions == sample_size) age();
+  }
+  /// Estimates the number of occurrences of given key.
+  [[nodiscard]] uint32_t estimate(std::string_view key) const {
+    auto slots = locate(key);
+    uint8_t minimum = UINT8_MAX;
+    for (size_t row = 0; row < kRows; ++row) minimum = std::min(minimum, counters[slots[row]]);
+    return minimum;
+  }
+
+ private:
+  static constexpr size_t kRows = 4;
+
+  /// The counter of given key in every row.
+  [[nodiscard]] std::array<size_t, kRows> locate(std::string_view key) const {
+    uint64_t hash = std::hash<std::string_view>{}(key);
+    // Derive the row hashes from two halves (Kirsch and Mitzenmacher)
+    auto first = static_cast<uint32_t>(hash);
+    auto second = static_cast<uint32_t>(hash >> 32) | 1;
+    std::array<size_t, kRows> slots;
+    for (size_t row = 0; row < kRows; ++row) {
+      slots[row] = row * (mask + 1) + ((first + row * second) & mask);
+    }
+    return slots;
+  }
+  /// Halves all counters.
+  void age() {
+    for (auto& counter : counters) counter >>= 1;
+    additions = 0;
+  }
+
+  /// The rows one after another.
+  std::vector<uint8_t> counters;
+  /// The number of counters per row minus one.
+  size_t mask;
+  /// The number of additions between two agings.
+  size_t sample_size;
+  size_t additions = 0;
+};
+//---------------------------------------------------------------------------
+#endif  // FREQUENCY_SKETCH_HPP
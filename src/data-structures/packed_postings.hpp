@@ -0,0 +1,218 @@
+#ifndef PACKED_POSTINGS_HPP
+#define PACKED_POSTINGS_HPP
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "data-structures/parallel_hash_table.hpp"
+//---------------------------------------------------------------------------
+/**
+ * The posting lists of a finished index, packed for reading.
+ *
+ * The postings of all lists lie back to back in one cache line aligned buffer, list i
+ * spans [offsets[i], offsets[i + 1]). Keys are found through an open addressing table of
+ * hash tags and list indexes, so a lookup reads a slot, the key, two adjacent offsets and
+ * then the postings, instead of following a bucket, its chain and a vector per list.
+ * Lists are appended once, the buffer grows like a vector unless reserved up front.
+ * Appending isn't thread-safe, but the postings of different lists may be written
+ * concurrently.
+ */
+template <typename Key, typename Posting>
+class PackedPostings {
+  // Postings are copied as raw memory
+  static_assert(std::is_standard_layout_v<Posting> && std::is_trivially_destructible_v<Posting>);
+
+ public:
+  /// The index of a key without a list.
+  static constexpr uint32_t kNotFound = std::numeric_limits<uint32_t>::max();
+  /// The alignment of the buffer.
+  static constexpr size_t kCacheLineSize = 64;
+
+  /// Constructor.
+  PackedPostings() = default;
+  /// Move Constructor.
+  PackedPostings(PackedPostings&& other) noexcept { *this = std::move(other); }
+  /// Move assignment. Leaves other without lists.
+  PackedPostings& operator=(PackedPostings&& other) noexcept {
+    if (this != &other) {
+      buffer = std::move(other.buffer);
+      capacity = std::exchange(other.capacity, 0);
+      offsets = std::move(other.offsets);
+      keys = std::move(other.keys);
+      slots = std::move(other.slots);
+      slot_mask = std::exchange(other.slot_mask, 0);
+      other.offsets.clear();
+      other.keys.clear();
+      other.slots.clear();
+    }
+    return *this;
+  }
+  PackedPostings(const PackedPostings&) = delete;
+  PackedPostings& operator=(const PackedPostings&) = delete;
+
+  /// Makes room for num_postings postings in total.
+  void reserve(uint64_t num_postings) {
+    if (num_postings > capacity) reallocate(num_postings);
+  }
+
+  /// Appends a list of count postings for key, which has none yet, and get its index. The
+  /// postings are written through postings(index).
+  uint32_t add(Key key, uint64_t count) {
+    if (offsets.empty()) offsets.push_back(0);
+    uint64_t end = offsets.back() + count;
+    if (end > capacity) reallocate(std::max(end, capacity * 2));
+    offsets.push_back(end);
+    keys.push_back(std::move(key));
+    auto index = static_cast<uint32_t>(keys.size() - 1);
+    if (keys.size() * 2 > slots.size()) {
+      rehash(std::max<size_t>(slots.size() * 2, 16));
+    } else {
+      insertSlot(index);
+    }
+    return index;
+  }
+  /// Appends a copy of postings as the list of key, which has none yet, and get its index.
+  uint32_t add(Key key, std::span<const Posting> postings) {
+    uint32_t index = add(std::move(key), postings.size());
+    std::copy(postings.begin(), postings.end(), this->postings(index).begin());
+    return index;
+  }
+
+  /// Get the index of the list of key, kNotFound if there is none.
+  template <typename LookupKey>
+  [[nodiscard]] uint32_t find(const LookupKey& key) const {
+    if (slots.empty()) return kNotFound;
+    size_t hash = Hasher<Key>{}(key);
+    auto tag = static_cast<uint32_t>(hash >> 32);
+    for (size_t slot = hash & slot_mask;; slot = (slot + 1) & slot_mask) {
+      const Slot& candidate = slots[slot];
+      if (candidate.index == kNotFound) return kNotFound;
+      if (candidate.tag == tag && keys[candidate.index] == key) return candidate.index;
+    }
+  }
+
+  /// Get the postings of a list.
+  [[nodiscard]] std::span<Posting> postings(uint32_t index) {
+    return {buffer.get() + offsets[index], buffer.get() + offsets[index + 1]};
+  }
+  /// Get the postings of a list.
+  [[nodiscard]] std::span<const Posting> postings(uint32_t index) const {
+    return {buffer.get() + offsets[index], buffer.get() + offsets[index + 1]};
+  }
+  /// Get the key of a list.
+  [[nodiscard]] const Key& key(uint32_t index) const { return keys[index]; }
+
+  /// Get the number of lists.
+  [[nodiscard]] size_t size() const { return keys.size(); }
+  /// Get the number of postings of all lists.
+  [[nodiscard]] uint64_t getPostingCount() const { return offsets.empty() ? 0 : offsets.back(); }
+
+  /// Removes the postings for which predicate(index, posting) holds, moving the later
+  /// ones forward, and shrinks the buffer to the remaining ones. Lists may become empty.
+  /// Get the number of removed postings.
+  template <typename Predicate>
+  uint64_t removeIf(Predicate predicate) {
+    uint64_t num_postings = getPostingCount();
+    uint64_t write = 0;
+    uint64_t begin = 0;
+    for (uint32_t index = 0; index < keys.size(); ++index) {
+      // The begin of this list was overwritten by the new end of the previous one
+      uint64_t end = offsets[index + 1];
+      for (uint64_t read = begin; read < end; ++read) {
+        if (!predicate(index, std::as_const(buffer[read]))) buffer[write++] = buffer[read];
+      }
+      begin = end;
+      offsets[index + 1] = write;
+    }
+    if (write < capacity) reallocate(write);
+    return num_postings - write;
+  }
+
+  /// Get the number of bytes used.
+  [[nodiscard]] uint64_t footprint_size() const {
+    uint64_t size = sizeof(PackedPostings) + getPostingCount() * sizeof(Posting) +
+                    offsets.size() * sizeof(uint64_t) + keys.size() * sizeof(Key) +
+                    slots.size() * sizeof(Slot);
+    if constexpr (std::is_same_v<Key, std::string>) {
+      for (const auto& key : keys) size += key.size();
+    }
+    return size;
+  }
+  /// Get the number of bytes allocated.
+  [[nodiscard]] uint64_t footprint_capacity() const {
+    uint64_t size = sizeof(PackedPostings) + capacity * sizeof(Posting) +
+                    offsets.capacity() * sizeof(uint64_t) + keys.capacity() * sizeof(Key) +
+                    slots.capacity() * sizeof(Slot);
+    if constexpr (std::is_same_v<Key, std::string>) {
+      // Short strings are stored inline
+      for (const auto& key : keys) {
+        if (key.capacity() > std::string().capacity()) size += key.capacity();
+      }
+    }
+    return size;
+  }
+
+ private:
+  /// A slot of the lookup table.
+  struct Slot {
+    /// The upper half of the key's hash.
+    uint32_t tag;
+    /// The index of the key's list, kNotFound if the slot is free.
+    uint32_t index;
+  };
+  /// Frees the buffer.
+  struct Deallocate {
+    void operator()(Posting* postings) const {
+      ::operator delete(postings, std::align_val_t(kCacheLineSize));
+    }
+  };
+
+  /// Moves the postings into a buffer of new_capacity postings.
+  void reallocate(uint64_t new_capacity) {
+    std::unique_ptr<Posting[], Deallocate> new_buffer;
+    if (new_capacity > 0) {
+      new_buffer.reset(static_cast<Posting*>(
+          ::operator new(new_capacity * sizeof(Posting), std::align_val_t(kCacheLineSize))));
+      std::copy(buffer.get(), buffer.get() + getPostingCount(), new_buffer.get());
+    }
+    buffer = std::move(new_buffer);
+    capacity = new_capacity;
+  }
+  /// Enters the list at index into the lookup table.
+  void insertSlot(uint32_t index) {
+    size_t hash = Hasher<Key>{}(keys[index]);
+    size_t slot = hash & slot_mask;
+    while (slots[slot].index != kNotFound) slot = (slot + 1) & slot_mask;
+    slots[slot] = {static_cast<uint32_t>(hash >> 32), index};
+  }
+  /// Rebuilds the lookup table with num_slots slots, a power of 2.
+  void rehash(size_t num_slots) {
+    slots.assign(num_slots, {0, kNotFound});
+    slot_mask = num_slots - 1;
+    for (uint32_t index = 0; index < keys.size(); ++index) insertSlot(index);
+  }
+
+  /// The postings of all lists.
+  std::unique_ptr<Posting[], Deallocate> buffer;
+  /// The number of postings that fit into buffer.
+  uint64_t capacity = 0;
+  /// The offset of every list's first posting in buffer and the end of the last one,
+  /// empty without lists.
+  std::vector<uint64_t> offsets;
+  /// The key of every list.
+  std::vector<Key> keys;
+  /// The lookup table, at most half full.
+  std::vector<Slot> slots;
+  /// The number of slots - 1.
+  size_t slot_mask = 0;
+};
+//---------------------------------------------------------------------------
+#endif  // PACKED_POSTINGS_HPP
@@ -4,7 +4,11 @@
 #include <deque>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 //---------------------------------------------------------------------------
 #include "utils.hpp"
@@ -19,14 +23,17 @@ struct Hasher<uint32_t> {
 //---------------------------------------------------------------------------
 template <>
 struct Hasher<std::string> {
+  using is_transparent = void;
   size_t operator()(const std::string& key) const { return std::hash<std::string>{}(key); }
+  /// Hashes like the equal std::string, for lookups without a temporary string.
+  size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
 };
 //---------------------------------------------------------------------------
 template <typename Key, typename Value>
 class ParallelHashTable {
  public:
   //---------------------------------------------------------------------------
-  using Chain = std::vector<std::pair<Key, Value>>;
+  using Chain = std::pmr::vector<std::pair<Key, Value>>;
   using Bucket = std::pair<Chain, utils::SpinLock>;
   using Table = std::deque<Bucket>;
   //---------------------------------------------------------------------------
@@ -70,10 +77,15 @@ class ParallelHashTable {
   //---------------------------------------------------------------------------
   /// Default Constructor.
   ParallelHashTable() = delete;
-  /// Constructor.
-  explicit ParallelHashTable(uint64_t size) {
+  /// Constructor. The chains of the buckets are allocated from resource, e.g. an Arena
+  /// that outlives the table.
+  explicit ParallelHashTable(
+      uint64_t size, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
     uint64_t table_size = utils::nextPowerOf2(size);
-    table.resize(table_size);
+    for (uint64_t i = 0; i < table_size; ++i) {
+      table.emplace_back(std::piecewise_construct, std::forward_as_tuple(resource),
+                         std::forward_as_tuple());
+    }
     table_mask = table_size - 1;
   }
   /// Copy Constructor.
@@ -126,14 +138,17 @@ class ParallelHashTable {
    * If the key is not in the map a new key value pair (Key, update(default_value)) is inserted
    * Threadsafe with concurrent inserts/updates
    * Not Threadsafe with concurrent reads
+   * The key is only converted to Key on insertion, so e.g. a std::string_view
+   * can update a std::string-keyed table without allocating.
+   * @tparam LookupKey
    * @tparam Functor
    * @param key
    * @param update
    * @param default_value
    */
-  template <typename Functor>
-  void updateOrInsert(const Key& key, Functor update, Value default_value) {
-    auto& cur = table[hash(key)];
+  template <typename LookupKey, typename Functor>
+  void updateOrInsert(const LookupKey& key, Functor update, Value default_value) {
+    auto& cur = table[Hasher<Key>{}(key) & table_mask];
     std::unique_lock lck(cur.second);
 
     for (auto& pair : cur.first) {
@@ -144,7 +159,7 @@ class ParallelHashTable {
     }
 
     update(default_value);
-    cur.first.push_back({key, default_value});
+    cur.first.emplace_back(Key(key), std::move(default_value));
   }
   /// The hash function for provided key on the table.
   size_t hash(const Key& k) const { return Hasher<Key>{}(k)&table_mask; }
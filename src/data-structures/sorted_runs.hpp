@@ -0,0 +1,199 @@
+#ifndef SORTED_RUNS_HPP
+#define SORTED_RUNS_HPP
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//---------------------------------------------------------------------------
+/// What an index build spilled to disk.
+struct SpillStatistics {
+  /// The number of runs written.
+  uint64_t runs = 0;
+  /// The number of bytes written.
+  uint64_t bytes = 0;
+};
+//---------------------------------------------------------------------------
+/**
+ * Sorted runs of postings spilled to disk while building an index larger than its
+ * memory budget (single-pass in-memory indexing).
+ *
+ * Every run is a file of keys in ascending order, each followed by its postings. merge
+ * streams all runs at once through a min-heap of their current keys, so it only holds
+ * one read buffer per run and the postings of one key in memory. Keys are std::string or
+ * trivially copyable, postings plain data like std::pair of integers. The files are
+ * removed on destruction.
+ */
+template <typename Key, typename Posting>
+class SortedRuns {
+  // Postings are written and read as raw bytes
+  static_assert(std::is_standard_layout_v<Posting> && std::is_trivially_destructible_v<Posting>);
+
+ public:
+  using Entry = std::pair<Key, std::vector<Posting>>;
+
+  /// Constructor. Creates a directory of its own for the runs below directory.
+  explicit SortedRuns(const std::filesystem::path& directory) {
+    std::random_device random;
+    uint64_t tag = (uint64_t{random()} << 32) | random();
+    path = directory / ("fts-runs-" + std::to_string(tag));
+    std::filesystem::create_directories(path);
+  }
+  /// Destructor. Removes the runs.
+  ~SortedRuns() {
+    std::error_code error;
+    std::filesystem::remove_all(path, error);
+  }
+  SortedRuns(const SortedRuns&) = delete;
+  SortedRuns& operator=(const SortedRuns&) = delete;
+
+  /// Sorts entries by key and writes them as a new run. Thread-safe.
+  void write(std::vector<Entry>& entries) {
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; });
+    std::filesystem::path run_path;
+    {
+      std::lock_guard lock(mutex);
+      run_path = path / ("run-" + std::to_string(run_paths.size()));
+      run_paths.push_back(run_path);
+    }
+
+    std::vector<char> buffer(kWriteBufferSize);
+    std::ofstream file;
+    file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.open(run_path, std::ios::binary);
+    for (const auto& [key, postings] : entries) {
+      postings_written += postings.size();
+      writeKey(file, key);
+      auto count = static_cast<uint32_t>(postings.size());
+      file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+      file.write(reinterpret_cast<const char*>(postings.data()),
+                 static_cast<std::streamsize>(count * sizeof(Posting)));
+    }
+    file.flush();
+    if (!file) throw std::runtime_error("Could not write run " + run_path.string());
+    bytes_written += static_cast<uint64_t>(file.tellp());
+    file.close();
+  }
+
+  /// Calls fn(key, postings) for every distinct key of all runs in ascending order. The
+  /// postings of a key are concatenated in the order their runs were written.
+  template <typename Fn>
+  void merge(Fn&& fn) {
+    std::vector<std::unique_ptr<Reader>> readers;
+    // Heap entries are the current key and the index of its reader
+    using HeapEntry = std::pair<Key, size_t>;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap;
+    for (const auto& run_path : run_paths) {
+      readers.push_back(std::make_unique<Reader>(run_path));
+      if (readers.back()->next()) heap.emplace(readers.back()->key, readers.size() - 1);
+    }
+
+    std::vector<size_t> sources;
+    std::vector<Posting> postings;
+    while (!heap.empty()) {
+      Key key = heap.top().first;
+      sources.clear();
+      while (!heap.empty() && heap.top().first == key) {
+        sources.push_back(heap.top().second);
+        heap.pop();
+      }
+      std::sort(sources.begin(), sources.end());
+
+      postings.clear();
+      for (size_t source : sources) {
+        readers[source]->appendPostings(postings);
+        if (readers[source]->next()) heap.emplace(readers[source]->key, source);
+      }
+      fn(key, postings);
+    }
+  }
+
+  /// Get the number of runs.
+  [[nodiscard]] size_t size() const { return run_paths.size(); }
+  /// Get the number of bytes written to the runs.
+  [[nodiscard]] uint64_t getBytesWritten() const { return bytes_written; }
+  /// Get the number of postings written to the runs.
+  [[nodiscard]] uint64_t getPostingCount() const { return postings_written; }
+  /// Get the number of runs and bytes written.
+  [[nodiscard]] SpillStatistics getStatistics() const { return {size(), bytes_written}; }
+
+ private:
+  /// The size of the buffer of a run being written.
+  static constexpr size_t kWriteBufferSize = 1 << 20;
+  /// The size of the buffer of every run being merged.
+  static constexpr size_t kReadBufferSize = 1 << 16;
+
+  /// Streams the entries of a run.
+  struct Reader {
+    explicit Reader(const std::filesystem::path& run_path) : buffer(kReadBufferSize) {
+      file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      file.open(run_path, std::ios::binary);
+      if (!file) throw std::runtime_error("Could not read run " + run_path.string());
+    }
+    /// Reads the next key and its posting count, false at the end of the run.
+    bool next() {
+      if (!readKey(file, key)) return false;
+      file.read(reinterpret_cast<char*>(&count), sizeof(count));
+      return static_cast<bool>(file);
+    }
+    /// Appends the postings of the current key.
+    void appendPostings(std::vector<Posting>& postings) {
+      size_t offset = postings.size();
+      postings.resize(offset + count);
+      file.read(reinterpret_cast<char*>(postings.data() + offset),
+                static_cast<std::streamsize>(count * sizeof(Posting)));
+    }
+
+    std::vector<char> buffer;
+    std::ifstream file;
+    Key key{};
+    uint32_t count = 0;
+  };
+
+  static void writeKey(std::ofstream& file, const Key& key) {
+    if constexpr (std::is_same_v<Key, std::string>) {
+      auto length = static_cast<uint32_t>(key.size());
+      file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+      file.write(key.data(), length);
+    } else {
+      static_assert(std::is_trivially_copyable_v<Key>);
+      file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    }
+  }
+  static bool readKey(std::ifstream& file, Key& key) {
+    if constexpr (std::is_same_v<Key, std::string>) {
+      uint32_t length;
+      if (!file.read(reinterpret_cast<char*>(&length), sizeof(length))) return false;
+      key.resize(length);
+      file.read(key.data(), length);
+    } else {
+      file.read(reinterpret_cast<char*>(&key), sizeof(key));
+    }
+    return static_cast<bool>(file);
+  }
+
+  /// The directory of the runs.
+  std::filesystem::path path;
+  /// Guards run_paths.
+  std::mutex mutex;
+  /// The files of the runs in the order they were written.
+  std::vector<std::filesystem::path> run_paths;
+  /// The number of bytes written to the runs.
+  std::atomic<uint64_t> bytes_written = 0;
+  /// The number of postings written to the runs.
+  std::atomic<uint64_t> postings_written = 0;
+};
+//---------------------------------------------------------------------------
+#endif  // SORTED_RUNS_HPP
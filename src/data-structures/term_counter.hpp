@@ -0,0 +1,93 @@
+#ifndef TERM_COUNTER_HPP
+#define TERM_COUNTER_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "utils.hpp"
+//---------------------------------------------------------------------------
+/**
+ * Counts the occurrences of terms within one document.
+ *
+ * An open-addressing table with linear probing over the distinct terms, which are
+ * kept in insertion order. The terms are not copied, so they must outlive the
+ * counter's next clear(). clear() only resets the slots in use, so one counter
+ * can be reused for every document of a thread without touching the allocator.
+ */
+class TermCounter {
+ public:
+  /// A distinct term and its number of occurrences.
+  struct Entry {
+    std::string_view term;
+    uint32_t count;
+  };
+
+  /// Constructor.
+  explicit TermCounter(size_t capacity = 64) : slots(utils::nextPowerOf2(2 * capacity), 0) {}
+
+  /// Counts one occurrence of given term.
+  void add(std::string_view term) {
+    if (2 * (entries.size() + 1) > slots.size()) grow();
+
+    uint64_t hash = std::hash<std::string_view>{}(term);
+    size_t slot = findSlot(term, hash);
+    if (slots[slot] != 0) {
+      ++entries[slots[slot] - 1].count;
+      return;
+    }
+    entries.push_back({term, 1});
+    locations.push_back({hash, slot});
+    slots[slot] = static_cast<uint32_t>(entries.size());
+  }
+  /// Removes all terms, keeping the allocated memory.
+  void clear() {
+    for (const auto& location : locations) slots[location.slot] = 0;
+    entries.clear();
+    locations.clear();
+  }
+
+  /// Get the number of distinct terms.
+  [[nodiscard]] size_t size() const { return entries.size(); }
+  /// The distinct terms in insertion order.
+  [[nodiscard]] std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+  [[nodiscard]] std::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+ private:
+  /// Where an entry's term is stored in the table.
+  struct Location {
+    uint64_t hash;
+    size_t slot;
+  };
+
+  /// The slot holding given term, or the empty slot it would be inserted into.
+  size_t findSlot(std::string_view term, uint64_t hash) const {
+    size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+      uint32_t index = slots[slot];
+      if (index == 0) return slot;
+      if (locations[index - 1].hash == hash && entries[index - 1].term == term) return slot;
+    }
+  }
+  /// Doubles the number of slots and reinserts all terms.
+  void grow() {
+    slots.assign(2 * slots.size(), 0);
+    size_t mask = slots.size() - 1;
+    for (size_t i = 0; i < locations.size(); ++i) {
+      size_t slot = locations[i].hash & mask;
+      while (slots[slot] != 0) slot = (slot + 1) & mask;
+      slots[slot] = static_cast<uint32_t>(i + 1);
+      locations[i].slot = slot;
+    }
+  }
+
+  /// The index of the slot's entry plus one, zero marks an empty slot.
+  std::vector<uint32_t> slots;
+  /// The distinct terms.
+  std::vector<Entry> entries;
+  /// The hash and slot of every entry.
+  std::vector<Location> locations;
+};
+//---------------------------------------------------------------------------
+#endif  // TERM_COUNTER_HPP
@@ -0,0 +1,74 @@
+#ifndef TOMBSTONES_HPP
+#define TOMBSTONES_HPP
+//---------------------------------------------------------------------------
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+//---------------------------------------------------------------------------
+/**
+ * Marks deleted documents of an index by their ids.
+ *
+ * A bitmap of atomic words, so documents can be deleted while queries test them with
+ * one relaxed load. Ids beyond the bitmap are live. Resizing is not thread-safe.
+ */
+class Tombstones {
+ public:
+  /// Constructor.
+  explicit Tombstones(uint64_t num_ids = 0) { resize(num_ids); }
+
+  /// Makes room for ids below num_ids, keeping the marks of the remaining ones.
+  void resize(uint64_t num_ids) {
+    uint64_t new_num_words = (num_ids + 63) / 64;
+    auto new_words = std::make_unique<std::atomic<uint64_t>[]>(new_num_words);
+    deleted = 0;
+    for (uint64_t i = 0; i < new_num_words; ++i) {
+      uint64_t word = i < num_words ? words[i].load(std::memory_order_relaxed) : 0;
+      if (i + 1 == new_num_words && num_ids % 64 != 0) word &= (uint64_t{1} << num_ids % 64) - 1;
+      new_words[i].store(word, std::memory_order_relaxed);
+      deleted += std::popcount(word);
+    }
+    words = std::move(new_words);
+    num_words = new_num_words;
+    size = num_ids;
+  }
+
+  /// Marks a document deleted, returns false if it already was or is beyond the bitmap.
+  bool erase(uint64_t id) {
+    if (id >= size) return false;
+    uint64_t mask = uint64_t{1} << id % 64;
+    if (words[id / 64].fetch_or(mask, std::memory_order_relaxed) & mask) return false;
+    ++deleted;
+    return true;
+  }
+  /// Marks a document live again, returns false if it already was.
+  bool revive(uint64_t id) {
+    if (id >= size) return false;
+    uint64_t mask = uint64_t{1} << id % 64;
+    if (!(words[id / 64].fetch_and(~mask, std::memory_order_relaxed) & mask)) return false;
+    --deleted;
+    return true;
+  }
+
+  /// Whether a document is deleted.
+  [[nodiscard]] bool contains(uint64_t id) const {
+    return id < size &&
+           (words[id / 64].load(std::memory_order_relaxed) >> (id % 64) & uint64_t{1}) != 0;
+  }
+  /// Get the number of deleted documents.
+  [[nodiscard]] uint64_t count() const { return deleted; }
+  /// Get the size of the bitmap in bytes.
+  [[nodiscard]] uint64_t footprint() const { return num_words * sizeof(uint64_t); }
+
+ private:
+  /// The marks, bit i % 64 of word i / 64 is set if document i is deleted.
+  std::unique_ptr<std::atomic<uint64_t>[]> words;
+  /// The number of words.
+  uint64_t num_words = 0;
+  /// The number of ids covered.
+  uint64_t size = 0;
+  /// The number of deleted documents.
+  std::atomic<uint64_t> deleted = 0;
+};
+//---------------------------------------------------------------------------
+#endif  // TOMBSTONES_HPP
@@ -0,0 +1,92 @@
+#ifndef TOP_K_HPP
+#define TOP_K_HPP
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+//---------------------------------------------------------------------------
+/**
+ * Selects the k best-scoring documents of a stream of candidates.
+ *
+ * A bounded binary min-heap of (score, doc id) whose root is the current k-th
+ * best candidate. Once the heap is full, the threshold rejects most candidates
+ * with one comparison, and an accepted one replaces the root with a single
+ * sift-down instead of the pop and push of a std::priority_queue.
+ *
+ * Candidates scoring equal to the threshold are rejected, so among tied
+ * documents the ones offered first are kept.
+ */
+class TopK {
+ public:
+  using Candidate = std::pair<double, uint32_t>;
+
+  /// Constructor.
+  explicit TopK(uint32_t k) : k(k) { heap.reserve(k); }
+
+  /// Offers a document.
+  void push(double score, uint32_t doc_id) {
+    if (heap.size() < k) {
+      heap.emplace_back(score, doc_id);
+      siftUp(heap.size() - 1);
+    } else if (k != 0 && score > heap.front().first) {
+      heap.front() = {score, doc_id};
+      siftDown(0);
+    }
+  }
+  /// Offers the documents selected by another instance.
+  void merge(const TopK& other) {
+    for (const auto& [score, doc_id] : other.heap) push(score, doc_id);
+  }
+
+  /// Whether k documents are selected.
+  [[nodiscard]] bool full() const { return heap.size() == k; }
+  /// Get the score a document must exceed to be selected, -infinity until full.
+  [[nodiscard]] double threshold() const {
+    return full() && k != 0 ? heap.front().first : -std::numeric_limits<double>::infinity();
+  }
+  /// Get the number of selected documents.
+  [[nodiscard]] size_t size() const { return heap.size(); }
+
+  /// Returns the selected documents by descending score and empties the selection.
+  std::vector<std::pair<uint32_t, double>> extract() {
+    std::sort(heap.begin(), heap.end(), std::greater<>());
+    std::vector<std::pair<uint32_t, double>> results;
+    results.reserve(heap.size());
+    for (const auto& [score, doc_id] : heap) results.emplace_back(doc_id, score);
+    heap.clear();
+    return results;
+  }
+
+ private:
+  void siftUp(size_t i) {
+    Candidate candidate = heap[i];
+    while (i > 0) {
+      size_t parent = (i - 1) / 2;
+      if (!(candidate < heap[parent])) break;
+      heap[i] = heap[parent];
+      i = parent;
+    }
+    heap[i] = candidate;
+  }
+  void siftDown(size_t i) {
+    Candidate candidate = heap[i];
+    size_t size = heap.size();
+    for (size_t child = 2 * i + 1; child < size; child = 2 * i + 1) {
+      if (child + 1 < size && heap[child + 1] < heap[child]) ++child;
+      if (!(heap[child] < candidate)) break;
+      heap[i] = heap[child];
+      i = child;
+    }
+    heap[i] = candidate;
+  }
+
+  /// The number of documents to select.
+  uint32_t k;
+  /// The selected documents, the worst one at the front.
+  std::vector<Candidate> heap;
+};
+//---------------------------------------------------------------------------
+#endif  // TOP_K_HPP
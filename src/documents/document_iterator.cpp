@@ -9,16 +9,31 @@
 
 DocumentIterator::DocumentIterator(const std::string &folder_path, uint32_t batch_size)
     : num_row_groups(0), row_group_index(0), batch_size(batch_size), row_batch_index(0) {
-  // Enqueue all Parquet files from the folder
-  for (const auto &entry : fs::directory_iterator(folder_path)) {
-    if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
-      file_queue.push(entry.path().string());
+  // Enqueue a single Parquet file or all Parquet files from the folder
+  if (fs::is_regular_file(folder_path)) {
+    file_queue.push(folder_path);
+  } else {
+    for (const auto &entry : fs::directory_iterator(folder_path)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+        file_queue.push(entry.path().string());
+      }
     }
   }
 
   loadNextRowGroup();
 }
 
+uint64_t DocumentIterator::countDocuments(const std::string &folder_path) {
+  uint64_t count = 0;
+  for (const auto &entry : fs::directory_iterator(folder_path)) {
+    if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+      auto reader = parquet::ParquetFileReader::OpenFile(entry.path().string());
+      count += static_cast<uint64_t>(reader->metadata()->num_rows());
+    }
+  }
+  return count;
+}
+
 bool DocumentIterator::loadNextFile() {
   if (file_queue.empty()) {
     arrow_reader.reset();
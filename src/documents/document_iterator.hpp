@@ -20,9 +20,15 @@ namespace fs = std::filesystem;
  */
 class DocumentIterator {
  public:
-  /// Constructor.
+  /// Constructor. Reads a single Parquet file or all Parquet files of a directory.
   explicit DocumentIterator(const std::string &folder_path, uint32_t batch_size = 128);
 
+  /// @brief Counts the documents in the given directory from the Parquet metadata,
+  /// without reading any data pages.
+  /// @param folder_path The directory containing the Parquet files.
+  /// @return The total number of rows.
+  static uint64_t countDocuments(const std::string &folder_path);
+
   /// @brief Produces the next batch of documents.
   /// @return The produced batch of documents.
   /// Empty if there are no documents left.
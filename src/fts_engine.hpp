@@ -1,6 +1,7 @@
 #ifndef FTS_ENGINE_HPP
 #define FTS_ENGINE_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -37,7 +38,8 @@ class FullTextSearchEngine {
    * @brief Searches for documents matching the given query.
    *
    * This method searches the indexed documents for matches to the given query
-   * and returns a list of matching document IDs.
+   * and returns a list of matching document IDs. Once the index is built,
+   * search may be called concurrently from several threads.
    *
    * @param query The search query as a string.
    * @param num_results Number of shown results.
@@ -70,6 +72,32 @@ class FullTextSearchEngine {
    * @return The indexed documents' average length.
    */
   virtual double getAvgDocumentLength() = 0;
+  /**
+   * @brief Normalizes a query for result caching.
+   *
+   * Queries with equal normal forms must have equal results. The default is the
+   * query itself, engines that tokenize queries return their token sequence.
+   *
+   * @param query The search query as a string.
+   * @return The normalized query.
+   */
+  virtual std::string normalizeQuery(const std::string &query) { return query; }
+  /**
+   * @brief Gets the version of the index.
+   *
+   * The version changes whenever the index is built or modified, so results
+   * computed for an older version are stale.
+   *
+   * @return The version of the index.
+   */
+  uint64_t getIndexVersion() const { return index_version_.load(); }
+
+ protected:
+  /// Marks the index as changed, to be called after every modification.
+  void markIndexChanged() { ++index_version_; }
+
+ private:
+  std::atomic<uint64_t> index_version_ = 0;
 };
 
 #endif  // FTS_ENGINE_HPP
@@ -1,3 +1,4 @@
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -5,10 +6,13 @@
 #include <vector>
 //---------------------------------------------------------------------------
 #include "algorithms/inverted/inverted_index_engine.hpp"
+#include "algorithms/inverted/segmented_index_engine.hpp"
 #include "algorithms/trigram/trigram_index_engine.hpp"
 #include "algorithms/vsm/vector_space_model_engine.hpp"
 #include "bootstrap/cli.hpp"
 #include "fts_engine.hpp"
+#include "queries/batch_executor.hpp"
+#include "queries/caching_engine.hpp"
 #include "queries/query_iterator.hpp"
 #include "scoring/bm25.hpp"
 #include "scoring/scoring_function.hpp"
@@ -22,22 +26,89 @@ int main(int argc, char** argv) {
   auto& algorithm_choice = options.algorithm;
   std::unique_ptr<FullTextSearchEngine> engine;
   if (algorithm_choice == "vsm") {
-    engine = std::make_unique<VectorSpaceModelEngine>();
+    engine = std::make_unique<VectorSpaceModelEngine>(options.stem_cache, options.unicode);
   } else if (algorithm_choice == "inverted") {
-    engine = std::make_unique<InvertedIndexEngine>();
+    InvertedIndexEngine::Precision precision;
+    if (options.precision == "double") {
+      precision = InvertedIndexEngine::Precision::Double;
+    } else if (options.precision == "float") {
+      precision = InvertedIndexEngine::Precision::Float;
+    } else if (options.precision == "quantized") {
+      precision = InvertedIndexEngine::Precision::Quantized;
+    } else {
+      throw std::invalid_argument("Invalid precision choice!");
+    }
+    engine = std::make_unique<InvertedIndexEngine>(
+        options.stem_cache, options.unicode, options.query_threads,
+        static_cast<uint64_t>(options.score_cache_mb) << 20, precision, options.reorder_documents);
+  } else if (algorithm_choice == "segmented") {
+    engine = std::make_unique<SegmentedIndexEngine>(options.stem_cache, options.unicode,
+                                                    options.merge_factor);
   } else if (algorithm_choice == "trigram") {
-    engine = std::make_unique<TrigramIndexEngine>();
+    engine = std::make_unique<TrigramIndexEngine>(options.unicode, options.fuzzy_distance);
   } else {
     throw std::invalid_argument("Invalid algorithm choice!");
   }
 
+  // Spill the postings beyond the memory budget to disk while building
+  if (options.build_memory_mb > 0) {
+    uint64_t budget = static_cast<uint64_t>(options.build_memory_mb) << 20;
+    std::string spill_dir = options.spill_dir.empty()
+                                ? std::filesystem::temp_directory_path().string()
+                                : options.spill_dir;
+    if (auto* inverted = dynamic_cast<InvertedIndexEngine*>(engine.get())) {
+      inverted->setMemoryBudget(budget, spill_dir);
+    } else if (auto* trigram = dynamic_cast<TrigramIndexEngine*>(engine.get())) {
+      trigram->setMemoryBudget(budget, spill_dir);
+    }
+  }
+
   // Build the FTS-Index
   engine->indexDocuments(options.data_path);
 
+  if (options.build_memory_mb > 0) {
+    const SpillStatistics* spilled = nullptr;
+    if (auto* inverted = dynamic_cast<InvertedIndexEngine*>(engine.get())) {
+      spilled = &inverted->getSpillStatistics();
+    } else if (auto* trigram = dynamic_cast<TrigramIndexEngine*>(engine.get())) {
+      spilled = &trigram->getSpillStatistics();
+    }
+    if (spilled != nullptr) {
+      std::cout << "Spilled: " << spilled->runs << " runs, " << (spilled->bytes >> 20)
+                << " MiB" << std::endl;
+    }
+  }
+
+  if (auto* inverted = dynamic_cast<InvertedIndexEngine*>(engine.get())) {
+    if (auto* stem_cache = inverted->getStemCache()) {
+      std::cout << "Stem cache: " << stem_cache->getHits() << " hits, " << stem_cache->getMisses()
+                << " misses, hit rate " << stem_cache->getHitRate() << std::endl;
+    }
+    if (options.reorder_documents) {
+      std::cout << "Document reordering: " << inverted->getAverageGapBits()
+                << " bits per document id gap" << std::endl;
+    }
+  }
+
+  if (auto* segmented = dynamic_cast<SegmentedIndexEngine*>(engine.get())) {
+    std::cout << "Segments: " << segmented->getSegmentCount() << " after "
+              << segmented->getMergeCount() << " merges" << std::endl;
+  }
+
   if (options.benchmarking_mode) {
     return 0;
   }
 
+  // Answer repeated queries from a result cache
+  auto* inverted_engine = dynamic_cast<InvertedIndexEngine*>(engine.get());
+  queries::CachingEngine* caching_engine = nullptr;
+  if (options.result_cache_mb > 0) {
+    auto cached = std::make_unique<queries::CachingEngine>(
+        std::move(engine), static_cast<uint64_t>(options.result_cache_mb) << 20);
+    caching_engine = cached.get();
+    engine = std::move(cached);
+  }
+
   // Define the scoring function used to score documents
   std::unique_ptr<scoring::ScoringFunction> score_func;
   auto& scoring_choice = options.scoring;
@@ -49,6 +120,32 @@ int main(int argc, char** argv) {
   } else {
     throw std::invalid_argument("Invalid scoring choice!");
   }
+  if (inverted_engine != nullptr && (options.pruning != "none" || options.max_df < 1.0)) {
+    InvertedIndexEngine::Pruning pruning;
+    if (options.pruning == "none") {
+      pruning = InvertedIndexEngine::Pruning::None;
+    } else if (options.pruning == "term") {
+      pruning = InvertedIndexEngine::Pruning::TermCentric;
+    } else if (options.pruning == "document") {
+      pruning = InvertedIndexEngine::Pruning::DocumentCentric;
+    } else {
+      throw std::invalid_argument("Invalid pruning choice!");
+    }
+    inverted_engine->prune(*score_func, pruning, options.prune_keep, options.max_df);
+    const auto& statistics = inverted_engine->getPruningStatistics();
+    std::cout << "Pruning: " << statistics.removed_terms << " frequent terms and "
+              << statistics.removed_postings << " postings removed, "
+              << statistics.remaining_postings << " postings left, index "
+              << inverted_engine->footprint_size() << " bytes" << std::endl;
+  }
+  if (inverted_engine != nullptr && options.impact_order) {
+    inverted_engine->orderByImpact(*score_func, options.posting_budget);
+  } else if (inverted_engine != nullptr && options.precision == "quantized") {
+    inverted_engine->quantizeImpacts(*score_func);
+  }
+  if (inverted_engine != nullptr && options.max_score) {
+    inverted_engine->computeMaxScores(*score_func);
+  }
 
   // Execute queries on the FTS-Index
   std::unique_ptr<queries::QueryIterator> query_engine;
@@ -64,25 +161,53 @@ int main(int argc, char** argv) {
   if (query_engine->getType() == queries::QueryIterator::Type::File) {
     fs::path output_path = fs::path(options.queries_path) / (options.scoring + "_result.tbl");
     std::ofstream file_output(output_path);
-    while (query_engine->hasNext()) {
-      queries::Query query = query_engine->next();
-
-      // Run query
-      std::vector<std::pair<DocumentID, double>> results;
-      std::cout << query.content << ": ";
-      {
-        auto start = std::chrono::high_resolution_clock::now();
-        results = engine->search(query.content, *score_func, options.num_results);
-        auto end = std::chrono::high_resolution_clock::now();
-        std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
-                  << std::endl;
-      }
+    auto write_results = [&file_output](const queries::Query& query,
+                                        const std::vector<std::pair<DocumentID, double>>& results) {
       uint32_t rank = 1;
       for (const auto& [doc_id, score] : results) {
         file_output << query.content << "|" << rank << "|" << doc_id << "|" << score << "|"
                     << std::endl;
         ++rank;
       }
+    };
+
+    if (options.batch_mode) {
+      // Run all queries on a thread pool, then report them in their original order
+      std::vector<queries::Query> batch;
+      while (query_engine->hasNext()) {
+        batch.push_back(query_engine->next());
+      }
+      queries::BatchExecutor executor(*engine, *score_func, options.num_results,
+                                      options.num_threads);
+      auto results = executor.run(batch);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        std::cout << batch[i].content << ": " << results[i].latency_ns << std::endl;
+        write_results(batch[i], results[i].documents);
+      }
+
+      const auto& statistics = executor.getStatistics();
+      std::cout << "Batch: " << statistics.num_queries << " queries on " << statistics.num_threads
+                << " threads in " << statistics.wall_time_ns << " ns, "
+                << statistics.queries_per_second << " QPS" << std::endl;
+      std::cout << "Latency (ns): mean " << statistics.mean_latency_ns << ", p50 "
+                << statistics.p50_latency_ns << ", p95 " << statistics.p95_latency_ns << ", p99 "
+                << statistics.p99_latency_ns << ", max " << statistics.max_latency_ns << std::endl;
+    } else {
+      while (query_engine->hasNext()) {
+        queries::Query query = query_engine->next();
+
+        // Run query
+        std::vector<std::pair<DocumentID, double>> results;
+        std::cout << query.content << ": ";
+        {
+          auto start = std::chrono::high_resolution_clock::now();
+          results = engine->search(query.content, *score_func, options.num_results);
+          auto end = std::chrono::high_resolution_clock::now();
+          std::cout << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+                    << std::endl;
+        }
+        write_results(query, results);
+      }
     }
   } else {
     while (query_engine->hasNext()) {
@@ -105,5 +230,19 @@ int main(int argc, char** argv) {
     }
   }
 
+  if (auto* score_cache = inverted_engine ? inverted_engine->getScoreCache() : nullptr) {
+    std::cout << "Score cache: " << score_cache->getHits() << " hits, " << score_cache->getMisses()
+              << " misses, hit rate " << score_cache->getHitRate() << ", "
+              << score_cache->getAdmissions() << " admitted, " << score_cache->getRejections()
+              << " rejected, " << score_cache->getEvictions() << " evicted, "
+              << score_cache->getSizeBytes() << " bytes" << std::endl;
+  }
+  if (caching_engine != nullptr) {
+    auto& cache = caching_engine->getCache();
+    std::cout << "Result cache: " << cache.getHits() << " hits, " << cache.getMisses()
+              << " misses, hit rate " << cache.getHitRate() << ", " << cache.size()
+              << " queries in " << cache.getSizeBytes() << " bytes" << std::endl;
+  }
+
   return 0;
 }
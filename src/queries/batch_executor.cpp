@@ -0,0 +1,87 @@
+#include "batch_executor.hpp"
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <thread>
+//---------------------------------------------------------------------------
+#include "queries/worker_pool.hpp"
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+namespace {
+//---------------------------------------------------------------------------
+uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              start)
+      .count();
+}
+//---------------------------------------------------------------------------
+/// The nearest-rank percentile of sorted values.
+uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) {
+  auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+//---------------------------------------------------------------------------
+}  // namespace
+//---------------------------------------------------------------------------
+BatchExecutor::BatchExecutor(FullTextSearchEngine& engine,
+                             const scoring::ScoringFunction& score_func, uint32_t num_results,
+                             size_t num_threads)
+    : engine(engine),
+      score_func(score_func),
+      num_results(num_results),
+      num_threads(num_threads != 0 ? num_threads
+                                   : std::max(1u, std::thread::hardware_concurrency())) {}
+//---------------------------------------------------------------------------
+std::vector<QueryResult> BatchExecutor::run(const std::vector<Query>& queries) {
+  std::vector<QueryResult> results(queries.size());
+  std::atomic<size_t> next_query = 0;
+
+  auto work = [&]() {
+    for (size_t i = next_query++; i < queries.size(); i = next_query++) {
+      auto start = std::chrono::steady_clock::now();
+      results[i].documents = engine.search(queries[i].content, score_func, num_results);
+      results[i].latency_ns = elapsedNanoseconds(start);
+    }
+  };
+
+  size_t num_workers = std::min(num_threads, std::max<size_t>(queries.size(), 1));
+  WorkerPool& pool = WorkerPool::shared();
+  pool.reserve(num_workers - 1);
+  auto start = std::chrono::steady_clock::now();
+  pool.run(num_workers, num_workers, [&work](size_t) { work(); });
+  uint64_t wall_time_ns = elapsedNanoseconds(start);
+
+  std::vector<uint64_t> latencies(results.size());
+  std::transform(results.begin(), results.end(), latencies.begin(),
+                 [](const QueryResult& result) { return result.latency_ns; });
+  statistics = summarize(std::move(latencies), wall_time_ns, num_workers);
+  return results;
+}
+//---------------------------------------------------------------------------
+BatchStatistics BatchExecutor::summarize(std::vector<uint64_t> latencies, uint64_t wall_time_ns,
+                                         size_t num_threads) {
+  BatchStatistics statistics;
+  statistics.num_queries = latencies.size();
+  statistics.num_threads = num_threads;
+  statistics.wall_time_ns = wall_time_ns;
+  if (latencies.empty()) return statistics;
+
+  if (wall_time_ns > 0) {
+    statistics.queries_per_second =
+        static_cast<double>(latencies.size()) * 1e9 / static_cast<double>(wall_time_ns);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  statistics.mean_latency_ns =
+      std::accumulate(latencies.begin(), latencies.end(), uint64_t{0}) / latencies.size();
+  statistics.p50_latency_ns = percentile(latencies, 0.50);
+  statistics.p95_latency_ns = percentile(latencies, 0.95);
+  statistics.p99_latency_ns = percentile(latencies, 0.99);
+  statistics.max_latency_ns = latencies.back();
+  return statistics;
+}
+//---------------------------------------------------------------------------
+}  // namespace queries
@@ -0,0 +1,69 @@
+#ifndef BATCH_EXECUTOR_HPP
+#define BATCH_EXECUTOR_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <utility>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "fts_engine.hpp"
+#include "queries/query_iterator.hpp"
+#include "scoring/scoring_function.hpp"
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+/// The ranked documents of one query and the time it took to compute them.
+struct QueryResult {
+  std::vector<std::pair<DocumentID, double>> documents;
+  uint64_t latency_ns = 0;
+};
+//---------------------------------------------------------------------------
+/// Throughput and latency distribution of one batch.
+struct BatchStatistics {
+  size_t num_queries = 0;
+  size_t num_threads = 0;
+  uint64_t wall_time_ns = 0;
+  double queries_per_second = 0.0;
+  uint64_t mean_latency_ns = 0;
+  uint64_t p50_latency_ns = 0;
+  uint64_t p95_latency_ns = 0;
+  uint64_t p99_latency_ns = 0;
+  uint64_t max_latency_ns = 0;
+};
+//---------------------------------------------------------------------------
+/**
+ * Runs a batch of queries on the shared WorkerPool.
+ *
+ * Workers claim the next unprocessed query from a shared counter, so long queries
+ * don't stall the others. Each result is stored at the index of its query, i.e.
+ * the results keep the order of the input. The engines keep their per-query
+ * scratch space in thread_local buffers, so every worker reuses its own
+ * accumulators across queries.
+ *
+ * The engine must be fully built, searching it is read-only.
+ */
+class BatchExecutor {
+ public:
+  /// Constructor. Uses all hardware threads if num_threads is 0.
+  BatchExecutor(FullTextSearchEngine& engine, const scoring::ScoringFunction& score_func,
+                uint32_t num_results, size_t num_threads = 0);
+
+  /// Runs all queries and returns their results in input order.
+  std::vector<QueryResult> run(const std::vector<Query>& queries);
+  /// The statistics of the last run.
+  [[nodiscard]] const BatchStatistics& getStatistics() const { return statistics; }
+
+  /// Aggregates per-query latencies measured during wall_time_ns.
+  static BatchStatistics summarize(std::vector<uint64_t> latencies, uint64_t wall_time_ns,
+                                   size_t num_threads);
+
+ private:
+  FullTextSearchEngine& engine;
+  const scoring::ScoringFunction& score_func;
+  uint32_t num_results;
+  size_t num_threads;
+  BatchStatistics statistics;
+};
+//---------------------------------------------------------------------------
+}  // namespace queries
+//---------------------------------------------------------------------------
+#endif  // BATCH_EXECUTOR_HPP
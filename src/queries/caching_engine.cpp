@@ -0,0 +1,49 @@
+#include "caching_engine.hpp"
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+CachingEngine::CachingEngine(std::unique_ptr<FullTextSearchEngine> engine,
+                             uint64_t capacity_bytes)
+    : engine(std::move(engine)), cache(capacity_bytes) {}
+//---------------------------------------------------------------------------
+void CachingEngine::indexDocuments(std::string& data_path) {
+  engine->indexDocuments(data_path);
+  markIndexChanged();
+}
+//---------------------------------------------------------------------------
+std::vector<std::pair<DocumentID, double>> CachingEngine::search(
+    const std::string& query, const scoring::ScoringFunction& score_func, uint32_t num_results) {
+  std::string key = engine->normalizeQuery(query);
+  key.push_back('\0');
+  key.append(score_func.getName());
+  key.push_back('\0');
+  key.append(std::to_string(num_results));
+
+  // The version is read first, so results racing with an index change are never newer
+  uint64_t version = engine->getIndexVersion();
+  std::vector<std::pair<DocumentID, double>> results;
+  if (cache.lookup(key, version, results)) {
+    return results;
+  }
+  results = engine->search(query, score_func, num_results);
+  cache.insert(key, version, results);
+  return results;
+}
+//---------------------------------------------------------------------------
+uint64_t CachingEngine::footprint_size() {
+  return engine->footprint_size() + cache.getSizeBytes() + sizeof(CachingEngine);
+}
+//---------------------------------------------------------------------------
+uint64_t CachingEngine::footprint_capacity() {
+  return engine->footprint_capacity() + cache.getSizeBytes() + sizeof(CachingEngine);
+}
+//---------------------------------------------------------------------------
+uint32_t CachingEngine::getDocumentCount() { return engine->getDocumentCount(); }
+//---------------------------------------------------------------------------
+double CachingEngine::getAvgDocumentLength() { return engine->getAvgDocumentLength(); }
+//---------------------------------------------------------------------------
+std::string CachingEngine::normalizeQuery(const std::string& query) {
+  return engine->normalizeQuery(query);
+}
+//---------------------------------------------------------------------------
+}  // namespace queries
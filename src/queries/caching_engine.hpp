@@ -0,0 +1,54 @@
+#ifndef CACHING_ENGINE_HPP
+#define CACHING_ENGINE_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "fts_engine.hpp"
+#include "queries/result_cache.hpp"
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+/**
+ * Answers repeated queries of another engine from a QueryResultCache.
+ *
+ * Results are cached under the engine's normalized query, the scoring
+ * function's name and the number of results. The entries belong to the
+ * engine's index version, so rebuilding or changing the index invalidates them.
+ */
+class CachingEngine : public FullTextSearchEngine {
+ public:
+  /// Constructor.
+  CachingEngine(std::unique_ptr<FullTextSearchEngine> engine, uint64_t capacity_bytes);
+
+  void indexDocuments(std::string& data_path) override;
+
+  std::vector<std::pair<DocumentID, double>> search(const std::string& query,
+                                                    const scoring::ScoringFunction& score_func,
+                                                    uint32_t num_results) override;
+
+  uint64_t footprint_size() override;
+
+  uint64_t footprint_capacity() override;
+
+  uint32_t getDocumentCount() override;
+
+  double getAvgDocumentLength() override;
+
+  std::string normalizeQuery(const std::string& query) override;
+
+  /// Get the wrapped engine.
+  [[nodiscard]] FullTextSearchEngine& getEngine() { return *engine; }
+  /// Get the result cache.
+  [[nodiscard]] QueryResultCache& getCache() { return cache; }
+
+ private:
+  std::unique_ptr<FullTextSearchEngine> engine;
+  QueryResultCache cache;
+};
+//---------------------------------------------------------------------------
+}  // namespace queries
+//---------------------------------------------------------------------------
+#endif  // CACHING_ENGINE_HPP
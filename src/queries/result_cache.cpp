@@ -0,0 +1,93 @@
+#include "result_cache.hpp"
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+namespace {
+//---------------------------------------------------------------------------
+/// The links of an entry's list node and its hash map node (next, key, position and hash).
+constexpr uint64_t kEntryOverhead =
+    2 * sizeof(void*) + sizeof(void*) + sizeof(std::string_view) + sizeof(void*) + sizeof(size_t);
+//---------------------------------------------------------------------------
+}  // namespace
+//---------------------------------------------------------------------------
+QueryResultCache::QueryResultCache(uint64_t capacity_bytes) : capacity_bytes(capacity_bytes) {}
+//---------------------------------------------------------------------------
+bool QueryResultCache::lookup(const std::string& key, uint64_t version, Results& results) {
+  std::lock_guard lock(mutex);
+  auto it = validate(version) ? positions.find(key) : positions.end();
+  if (it == positions.end()) {
+    ++misses;
+    return false;
+  }
+  ++hits;
+  entries.splice(entries.begin(), entries, it->second);
+  results = it->second->results;
+  return true;
+}
+//---------------------------------------------------------------------------
+void QueryResultCache::insert(const std::string& key, uint64_t version, Results results) {
+  uint64_t bytes = sizeof(Entry) + kEntryOverhead + key.size() +
+                   results.size() * sizeof(Results::value_type);
+  if (bytes > capacity_bytes) return;
+
+  std::lock_guard lock(mutex);
+  if (!validate(version) || positions.contains(key)) return;
+  while (size_bytes + bytes > capacity_bytes) evict();
+
+  results.shrink_to_fit();
+  entries.push_front({key, std::move(results), bytes});
+  positions.emplace(entries.front().key, entries.begin());
+  size_bytes += bytes;
+}
+//---------------------------------------------------------------------------
+void QueryResultCache::clear() {
+  std::lock_guard lock(mutex);
+  positions.clear();
+  entries.clear();
+  size_bytes = 0;
+}
+//---------------------------------------------------------------------------
+size_t QueryResultCache::size() {
+  std::lock_guard lock(mutex);
+  return entries.size();
+}
+//---------------------------------------------------------------------------
+uint64_t QueryResultCache::getSizeBytes() {
+  std::lock_guard lock(mutex);
+  return size_bytes;
+}
+//---------------------------------------------------------------------------
+uint64_t QueryResultCache::getHits() {
+  std::lock_guard lock(mutex);
+  return hits;
+}
+//---------------------------------------------------------------------------
+uint64_t QueryResultCache::getMisses() {
+  std::lock_guard lock(mutex);
+  return misses;
+}
+//---------------------------------------------------------------------------
+double QueryResultCache::getHitRate() {
+  std::lock_guard lock(mutex);
+  return hits + misses == 0 ? 0.0
+                            : static_cast<double>(hits) / static_cast<double>(hits + misses);
+}
+//---------------------------------------------------------------------------
+bool QueryResultCache::validate(uint64_t version) {
+  if (version < this->version) return false;
+  if (version > this->version) {
+    positions.clear();
+    entries.clear();
+    size_bytes = 0;
+    this->version = version;
+  }
+  return true;
+}
+//---------------------------------------------------------------------------
+void QueryResultCache::evict() {
+  positions.erase(entries.back().key);
+  size_bytes -= entries.back().bytes;
+  entries.pop_back();
+}
+//---------------------------------------------------------------------------
+}  // namespace queries
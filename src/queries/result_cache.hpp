@@ -0,0 +1,76 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "fts_engine.hpp"
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+/**
+ * A least recently used cache of query results, bounded by its memory usage.
+ *
+ * Every entry belongs to an index version. Inserting or looking up a newer
+ * version drops all entries of the older ones, results computed on an older
+ * version than the cached ones are not inserted. All members are thread-safe.
+ */
+class QueryResultCache {
+ public:
+  using Results = std::vector<std::pair<DocumentID, double>>;
+
+  /// Constructor.
+  explicit QueryResultCache(uint64_t capacity_bytes);
+
+  /// Copies the results cached for key on given index version, returns whether there were any.
+  bool lookup(const std::string& key, uint64_t version, Results& results);
+  /// Caches the results of key computed on given index version, evicts the least recently
+  /// used entries to stay within the capacity.
+  void insert(const std::string& key, uint64_t version, Results results);
+  /// Drops all entries.
+  void clear();
+
+  /// Get the number of cached queries.
+  [[nodiscard]] size_t size();
+  /// Get the estimated memory usage of all entries in bytes.
+  [[nodiscard]] uint64_t getSizeBytes();
+  /// Get the number of lookups that found an entry.
+  [[nodiscard]] uint64_t getHits();
+  /// Get the number of lookups that found no entry.
+  [[nodiscard]] uint64_t getMisses();
+  /// Get the share of lookups that found an entry.
+  [[nodiscard]] double getHitRate();
+
+ private:
+  struct Entry {
+    std::string key;
+    Results results;
+    uint64_t bytes;
+  };
+
+  /// Drops all entries of older versions than given one, returns whether version is current.
+  bool validate(uint64_t version);
+  /// Removes the least recently used entry.
+  void evict();
+
+  /// The entries, most recently used first.
+  std::list<Entry> entries;
+  /// key is an entry's key, value is its position in entries
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> positions;
+  uint64_t capacity_bytes;
+  uint64_t size_bytes = 0;
+  uint64_t version = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  std::mutex mutex;
+};
+//---------------------------------------------------------------------------
+}  // namespace queries
+//---------------------------------------------------------------------------
+#endif  // RESULT_CACHE_HPP
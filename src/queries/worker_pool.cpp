@@ -0,0 +1,110 @@
+#include "worker_pool.hpp"
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <memory>
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+namespace {
+//---------------------------------------------------------------------------
+/// The state of one run, shared with its queued tasks, which may outlive the run.
+struct Job {
+  const std::function<void(size_t)>* fn;
+  size_t count;
+  /// The next index to claim.
+  std::atomic<size_t> next = 0;
+  /// Guards finished.
+  std::mutex mutex;
+  /// Signals the last finished index.
+  std::condition_variable done;
+  /// The number of finished indexes.
+  size_t finished = 0;
+
+  /// Processes indexes until none are left.
+  void claim() {
+    size_t num_processed = 0;
+    for (size_t i = next++; i < count; i = next++) {
+      (*fn)(i);
+      ++num_processed;
+    }
+    finish(num_processed);
+  }
+  /// Counts num_processed more indexes as finished.
+  void finish(size_t num_processed) {
+    if (num_processed == 0) return;
+    std::lock_guard lock(mutex);
+    finished += num_processed;
+    if (finished == count) done.notify_all();
+  }
+};
+//---------------------------------------------------------------------------
+}  // namespace
+//---------------------------------------------------------------------------
+WorkerPool::WorkerPool(size_t num_workers) { reserve(num_workers); }
+//---------------------------------------------------------------------------
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto& worker : workers) worker.join();
+}
+//---------------------------------------------------------------------------
+WorkerPool& WorkerPool::shared() {
+  static WorkerPool pool;
+  return pool;
+}
+//---------------------------------------------------------------------------
+void WorkerPool::reserve(size_t num_workers) {
+  std::lock_guard lock(mutex);
+  while (workers.size() < num_workers) workers.emplace_back([this]() { work(); });
+}
+//---------------------------------------------------------------------------
+void WorkerPool::run(size_t count, size_t parallelism, const std::function<void(size_t)>& fn) {
+  if (count == 0) return;
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->count = count;
+
+  // Idle workers join in with the other indexes while the calling thread processes the
+  // first one, then it takes what they didn't get to
+  size_t num_helpers = std::min(parallelism, count) - 1;
+  if (num_helpers > 0) {
+    job->next = 1;
+    {
+      std::lock_guard lock(mutex);
+      for (size_t i = 0; i < num_helpers; ++i) tasks.emplace([job]() { job->claim(); });
+    }
+    wake.notify_all();
+    fn(0);
+    job->finish(1);
+  }
+  job->claim();
+
+  // Wait for the indexes the workers are still processing
+  std::unique_lock lock(job->mutex);
+  job->done.wait(lock, [&job]() { return job->finished == job->count; });
+}
+//---------------------------------------------------------------------------
+size_t WorkerPool::size() {
+  std::lock_guard lock(mutex);
+  return workers.size();
+}
+//---------------------------------------------------------------------------
+void WorkerPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(mutex);
+      wake.wait(lock, [this]() { return stopping || !tasks.empty(); });
+      if (tasks.empty()) return;
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+  }
+}
+//---------------------------------------------------------------------------
+}  // namespace queries
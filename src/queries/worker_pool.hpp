@@ -0,0 +1,62 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+//---------------------------------------------------------------------------
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+//---------------------------------------------------------------------------
+namespace queries {
+//---------------------------------------------------------------------------
+/**
+ * Persistent worker threads shared by all query processing of the process.
+ *
+ * run spreads the indexes of a job over the idle workers and the calling thread, which
+ * claims indexes itself until none are left. A job started from a worker, e.g. the
+ * ranges of one query of a batch, therefore never waits for a free worker: if all are
+ * busy, the caller processes the whole job. Batches and parallel queries thus share one
+ * set of threads instead of multiplying their own, and no thread is started per query.
+ */
+class WorkerPool {
+ public:
+  /// Constructor. Starts num_workers threads.
+  explicit WorkerPool(size_t num_workers = 0);
+  /// Destructor. Finishes the queued jobs and joins the workers.
+  ~WorkerPool();
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /// Get the pool of the process, without workers until reserve.
+  static WorkerPool& shared();
+
+  /// Starts workers until there are at least num_workers. Thread-safe.
+  void reserve(size_t num_workers);
+  /// Calls fn(index) for every index in [0, count) on up to parallelism threads, the
+  /// calling one included, and returns when all calls are done. Thread-safe.
+  void run(size_t count, size_t parallelism, const std::function<void(size_t)>& fn);
+
+  /// Get the number of workers.
+  [[nodiscard]] size_t size();
+
+ private:
+  /// Runs the queued tasks until the pool is destroyed.
+  void work();
+
+  /// Guards all members but the workers' own state.
+  std::mutex mutex;
+  /// Signals queued tasks and stopping.
+  std::condition_variable wake;
+  /// The tasks not yet picked up by a worker.
+  std::queue<std::function<void()>> tasks;
+  /// The worker threads.
+  std::vector<std::thread> workers;
+  /// Whether the workers exit once the queue is empty.
+  bool stopping = false;
+};
+//---------------------------------------------------------------------------
+}  // namespace queries
+//---------------------------------------------------------------------------
+#endif  // WORKER_POOL_HPP
@@ -1,5 +1,7 @@
 #include "bm25.hpp"
 //---------------------------------------------------------------------------
+#include <sstream>
+//---------------------------------------------------------------------------
 namespace scoring {
 //---------------------------------------------------------------------------
 BM25::BM25(uint32_t doc_count, double avg_doc_length)
@@ -22,4 +24,10 @@ double BM25::score(const DocStats& doc_stats, const WordStats& word_stats, doubl
            (k1 * (1.0 - b + b * (static_cast<double>(doc_stats.doc_length) / avg_doc_length)))));
 }
 //---------------------------------------------------------------------------
-}  // namespace scoring
+std::string BM25::getName() const {
+  std::ostringstream name;
+  name << "bm25(k1=" << k1 << ",b=" << b << ")";
+  return name.str();
+}
+//---------------------------------------------------------------------------
+}  // namespace scoring
\ No newline at end of file
@@ -15,6 +15,8 @@ class BM25 : public ScoringFunction {
   double score(const DocStats& doc_stats, const WordStats& word_stats) const override;
   /// Calculates the BM25 score for a given document, word and idf.
   double score(const DocStats& doc_stats, const WordStats& word_stats, double idf) const override;
+  /// Returns "bm25" and the parameters, e.g. "bm25(k1=1.5,b=0.75)".
+  std::string getName() const override;
 
  private:
   /// The total number of documents.
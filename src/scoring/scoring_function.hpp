@@ -3,6 +3,7 @@
 //---------------------------------------------------------------------------
 #include <cmath>
 #include <cstdint>
+#include <string>
 //---------------------------------------------------------------------------
 namespace scoring {
 //---------------------------------------------------------------------------
@@ -53,6 +54,14 @@ class ScoringFunction {
    */
   [[nodiscard]] virtual double score(const DocStats& doc_stats, const WordStats& word_stats,
                                      double idf) const = 0;
+  /**
+   * Identifies the scoring function and its parameters.
+   *
+   * Scoring functions with equal names rank equally on the same index.
+   *
+   * @return The name of the scoring function.
+   */
+  [[nodiscard]] virtual std::string getName() const = 0;
 };
 //---------------------------------------------------------------------------
 /**
@@ -14,4 +14,6 @@ double TfIdf::score(const DocStats& doc_stats, const WordStats& word_stats, doub
          idf;
 }
 //---------------------------------------------------------------------------
+std::string TfIdf::getName() const { return "tf-idf"; }
+//---------------------------------------------------------------------------
 }  // namespace scoring
\ No newline at end of file
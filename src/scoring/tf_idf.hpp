@@ -13,6 +13,8 @@ class TfIdf : public ScoringFunction {
   double score(const DocStats& doc_stats, const WordStats& word_stats) const override;
   /// Calculates the tf-idf score for a given document, word and idf.
   double score(const DocStats& doc_stats, const WordStats& word_stats, double idf) const override;
+  /// Returns "tf-idf".
+  std::string getName() const override;
 
  private:
   /// The total number of documents.
@@ -0,0 +1,53 @@
+#include "batch_tokenizer.hpp"
+//---------------------------------------------------------------------------
+#include "simd_scan.hpp"
+#include "tokenizer_rules.hpp"
+#include "utf8.hpp"
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+BatchTokenizer::BatchTokenizer(bool stem, bool skip_stop_words, StemCache *cache, bool unicode)
+    : stem(stem), skip_stop_words(skip_stop_words), unicode(unicode), stemmer(cache) {}
+//---------------------------------------------------------------------------
+void BatchTokenizer::tokenize(const std::vector<Document> &docs, TokenBatch &out) {
+  out.clear();
+  for (const auto &doc : docs) {
+    append(doc.getData(), doc.getSize(), out);
+  }
+}
+//---------------------------------------------------------------------------
+void BatchTokenizer::append(const char *data, size_t size, TokenBatch &out) {
+  auto doc_index = static_cast<uint32_t>(out.numDocuments());
+  uint32_t position = 0;
+
+  const char *end = data + size;
+  if (unicode && !isAscii(data, size)) {
+    for (const char *it = utf8::findWordBegin(data, end); it < end;
+         it = utf8::findWordBegin(it, end)) {
+      lowered.clear();
+      it = utf8::appendFoldedWord(it, end, lowered);
+      emit(doc_index, position, out);
+    }
+  } else {
+    for (const char *it = findTokenBegin(data, end); it < end; it = findTokenBegin(it, end)) {
+      const char *token_end = findTokenEnd(it, end);
+      lowered.resize(token_end - it);
+      toLower(it, lowered.size(), lowered.data());
+      it = token_end;
+      emit(doc_index, position, out);
+    }
+  }
+
+  out.doc_offsets.push_back(static_cast<uint32_t>(out.size()));
+}
+//---------------------------------------------------------------------------
+void BatchTokenizer::emit(uint32_t doc_index, uint32_t &position, TokenBatch &out) {
+  if (skip_stop_words && isStopWord(lowered)) return;
+
+  out.bytes.append(stem ? stemmer.stem(lowered) : std::string_view(lowered));
+  out.offsets.push_back(static_cast<uint32_t>(out.bytes.size()));
+  out.doc_indices.push_back(doc_index);
+  out.positions.push_back(position++);
+}
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
@@ -0,0 +1,89 @@
+#ifndef BATCH_TOKENIZER_HPP
+#define BATCH_TOKENIZER_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "documents/document.hpp"
+#include "stem_cache.hpp"
+#include "stemmer.hpp"
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+/**
+ * The tokens of a whole document batch in columnar form.
+ *
+ * Token i consists of the bytes [offsets[i], offsets[i + 1]), belongs to the
+ * document doc_indices[i] of the batch and is the positions[i]-th token emitted
+ * for that document. The tokens of document d are [doc_offsets[d], doc_offsets[d + 1]).
+ */
+struct TokenBatch {
+  /// The bytes of all tokens, concatenated.
+  std::string bytes;
+  /// The begin of every token in bytes, followed by the end of the last token.
+  std::vector<uint32_t> offsets{0};
+  /// The index of the token's document within the batch.
+  std::vector<uint32_t> doc_indices;
+  /// The token's position within its document, counting emitted tokens only.
+  std::vector<uint32_t> positions;
+  /// The first token of every document, followed by the total number of tokens.
+  std::vector<uint32_t> doc_offsets{0};
+
+  /// Get the number of tokens.
+  [[nodiscard]] size_t size() const { return doc_indices.size(); }
+  /// Get the number of documents.
+  [[nodiscard]] size_t numDocuments() const { return doc_offsets.size() - 1; }
+  /// Get token i.
+  [[nodiscard]] std::string_view token(size_t i) const {
+    return {bytes.data() + offsets[i], offsets[i + 1] - offsets[i]};
+  }
+  /// Remove all tokens, keeping the allocated memory.
+  void clear() {
+    bytes.clear();
+    offsets.resize(1);
+    doc_indices.clear();
+    positions.clear();
+    doc_offsets.resize(1);
+  }
+};
+//---------------------------------------------------------------------------
+/**
+ * Tokenizes whole document batches into a TokenBatch.
+ *
+ * Applies the same rules as SimpleTokenizer and StemmingTokenizer, but without a
+ * virtual call or string allocation per token. Meant to be reused across batches
+ * by a single thread. In unicode mode, documents containing non-ASCII bytes are
+ * tokenized like Utf8Tokenizer does.
+ */
+class BatchTokenizer {
+ public:
+  /// Constructor. Stems the tokens if stem is set, memoizing them in given cache, if any.
+  BatchTokenizer(bool stem, bool skip_stop_words, StemCache *cache = nullptr,
+                 bool unicode = false);
+
+  /// Replaces the content of out by the tokens of the given documents.
+  void tokenize(const std::vector<Document> &docs, TokenBatch &out);
+  /// Appends the tokens of given text to out as a new document.
+  void append(const char *data, size_t size, TokenBatch &out);
+
+ private:
+  /// Appends the lower-cased token to out unless it is a stop word.
+  void emit(uint32_t doc_index, uint32_t &position, TokenBatch &out);
+
+  /// Whether the tokens are stemmed.
+  bool stem;
+  /// Whether stop words are dropped.
+  bool skip_stop_words;
+  /// Whether non-ASCII letters are kept and case-folded.
+  bool unicode;
+  /// The stemmer.
+  Stemmer stemmer;
+  /// Receives the lower-cased token.
+  std::string lowered;
+};
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // BATCH_TOKENIZER_HPP
@@ -0,0 +1,129 @@
+#ifndef SIMD_SCAN_HPP
+#define SIMD_SCAN_HPP
+//---------------------------------------------------------------------------
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+//---------------------------------------------------------------------------
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+//---------------------------------------------------------------------------
+#include "tokenizer_rules.hpp"
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+/**
+ * Byte-at-a-time reference implementations of the scanning primitives.
+ * The vectorized versions below must produce exactly the same results.
+ */
+namespace scalar {
+//---------------------------------------------------------------------------
+/// Returns the first token character in [it, end), or end.
+inline const char *findTokenBegin(const char *it, const char *end) {
+  while (it < end && isDelimiter(*it)) ++it;
+  return it;
+}
+//---------------------------------------------------------------------------
+/// Returns the first delimiter in [it, end), or end.
+inline const char *findTokenEnd(const char *it, const char *end) {
+  while (it < end && !isDelimiter(*it)) ++it;
+  return it;
+}
+//---------------------------------------------------------------------------
+/// Lower-cases the ASCII letters of size bytes from src into out.
+inline void toLower(const char *src, size_t size, char *out) {
+  for (size_t i = 0; i < size; ++i) {
+    char c = src[i];
+    out[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+  }
+}
+//---------------------------------------------------------------------------
+/// Whether all of the size bytes at data are ASCII.
+inline bool isAscii(const char *data, size_t size) {
+  uint8_t high_bits = 0;
+  for (size_t i = 0; i < size; ++i) high_bits |= static_cast<uint8_t>(data[i]);
+  return high_bits < 0x80;
+}
+//---------------------------------------------------------------------------
+}  // namespace scalar
+//---------------------------------------------------------------------------
+#ifdef __AVX2__
+namespace avx2 {
+//---------------------------------------------------------------------------
+/// Whether a <= v <= b for each signed byte. Bytes >= 128 are negative and never match.
+inline __m256i inRange(__m256i v, char a, char b) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(a - 1))),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(b + 1)), v));
+}
+//---------------------------------------------------------------------------
+/// Classifies 32 bytes, bit i is set if byte i is a token character (see DELIM_CHARS).
+inline uint32_t tokenMask(const char *it) {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(it));
+  // Setting bit 5 folds upper-case into lower-case letters without creating new letters.
+  __m256i letters = inRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+  __m256i digits = inRange(v, '0', '9');
+  // '$', '%' and '&' are consecutive.
+  __m256i specials = _mm256_or_si256(
+      inRange(v, '$', '&'), _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('+')),
+                                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('@'))));
+  __m256i token = _mm256_or_si256(letters, _mm256_or_si256(digits, specials));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(token));
+}
+//---------------------------------------------------------------------------
+}  // namespace avx2
+#endif
+//---------------------------------------------------------------------------
+/// Returns the first token character in [it, end), or end.
+inline const char *findTokenBegin(const char *it, const char *end) {
+#ifdef __AVX2__
+  for (; end - it >= 32; it += 32) {
+    uint32_t mask = avx2::tokenMask(it);
+    if (mask != 0) return it + std::countr_zero(mask);
+  }
+#endif
+  return scalar::findTokenBegin(it, end);
+}
+//---------------------------------------------------------------------------
+/// Returns the first delimiter in [it, end), or end.
+inline const char *findTokenEnd(const char *it, const char *end) {
+#ifdef __AVX2__
+  for (; end - it >= 32; it += 32) {
+    uint32_t mask = ~avx2::tokenMask(it);
+    if (mask != 0) return it + std::countr_zero(mask);
+  }
+#endif
+  return scalar::findTokenEnd(it, end);
+}
+//---------------------------------------------------------------------------
+/// Lower-cases the ASCII letters of size bytes from src into out.
+inline void toLower(const char *src, size_t size, char *out) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    __m256i upper = avx2::inRange(v, 'A', 'Z');
+    v = _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8('a' - 'A')));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), v);
+  }
+#endif
+  scalar::toLower(src + i, size - i, out + i);
+}
+//---------------------------------------------------------------------------
+/// Whether all of the size bytes at data are ASCII.
+inline bool isAscii(const char *data, size_t size) {
+  size_t i = 0;
+#ifdef __AVX2__
+  __m256i high_bits = _mm256_setzero_si256();
+  for (; i + 32 <= size; i += 32) {
+    high_bits = _mm256_or_si256(
+        high_bits, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+  }
+  if (_mm256_movemask_epi8(high_bits) != 0) return false;
+#endif
+  return scalar::isAscii(data + i, size - i);
+}
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // SIMD_SCAN_HPP
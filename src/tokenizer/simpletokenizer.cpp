@@ -4,6 +4,7 @@
 
 #include "simpletokenizer.hpp"
 
+#include "simd_scan.hpp"
 #include "tokenizer_rules.hpp"
 namespace tokenizer {
 
@@ -13,10 +14,7 @@ SimpleTokenizer::SimpleTokenizer(const char* data, size_t size)
 }
 
 inline void SimpleTokenizer::skipDelimiters() {
-  const auto* udata = reinterpret_cast<const unsigned char*>(data_);
-  while (currentPos_ < size_ && DELIMS[udata[currentPos_]]) {
-    ++currentPos_;
-  }
+  currentPos_ = findTokenBegin(data_ + currentPos_, data_ + size_) - data_;
 }
 
 std::string SimpleTokenizer::nextToken(bool skip_stop_words) {
@@ -26,22 +24,15 @@ std::string SimpleTokenizer::nextToken(bool skip_stop_words) {
       return "";
     }
 
-    const auto* udata = reinterpret_cast<const unsigned char*>(data_);
     size_t tokenStart = currentPos_;
-
-    while (currentPos_ < size_ && !DELIMS[udata[currentPos_]]) {
-      ++currentPos_;
-    }
+    currentPos_ = findTokenEnd(data_ + currentPos_, data_ + size_) - data_;
 
     size_t tokenLength = currentPos_ - tokenStart;
 
-    tokenBuffer_.assign(data_ + tokenStart, tokenLength);
-
-    for (char& c : tokenBuffer_) {
-      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-    }
+    tokenBuffer_.resize(tokenLength);
+    toLower(data_ + tokenStart, tokenLength, tokenBuffer_.data());
 
-    if (skip_stop_words && STOP_WORDS.contains(tokenBuffer_)) {
+    if (skip_stop_words && isStopWord(tokenBuffer_)) {
       continue;
     }
 
@@ -0,0 +1,78 @@
+#include "stem_cache.hpp"
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <functional>
+#include <mutex>
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+StemCache::StemCache(size_t capacity) : shards(std::make_unique<Shard[]>(kNumShards)) {
+  uint64_t slots_per_shard = utils::nextPowerOf2(std::max<size_t>(capacity / kNumShards, 1));
+  slot_mask = slots_per_shard - 1;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    shards[i].entries.resize(slots_per_shard);
+  }
+}
+//---------------------------------------------------------------------------
+bool StemCache::lookup(std::string_view surface, std::string& stem) {
+  if (surface.size() > kMaxTokenLength) return false;
+
+  uint64_t hash = std::hash<std::string_view>{}(surface);
+  auto& shard = shards[hash & (kNumShards - 1)];
+  auto& entry = shard.entries[(hash >> 6) & slot_mask];
+
+  std::unique_lock lck(shard.lock);
+  if (entry.surface == surface) {
+    stem.assign(entry.stem);
+    ++shard.hits;
+    return true;
+  }
+  ++shard.misses;
+  return false;
+}
+//---------------------------------------------------------------------------
+void StemCache::insert(std::string_view surface, std::string_view stem) {
+  if (surface.empty() || surface.size() > kMaxTokenLength) return;
+
+  uint64_t hash = std::hash<std::string_view>{}(surface);
+  auto& shard = shards[hash & (kNumShards - 1)];
+  auto& entry = shard.entries[(hash >> 6) & slot_mask];
+
+  std::unique_lock lck(shard.lock);
+  entry.surface.assign(surface);
+  entry.stem.assign(stem);
+}
+//---------------------------------------------------------------------------
+uint64_t StemCache::getHits() const {
+  uint64_t hits = 0;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    std::unique_lock lck(shards[i].lock);
+    hits += shards[i].hits;
+  }
+  return hits;
+}
+//---------------------------------------------------------------------------
+uint64_t StemCache::getMisses() const {
+  uint64_t misses = 0;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    std::unique_lock lck(shards[i].lock);
+    misses += shards[i].misses;
+  }
+  return misses;
+}
+//---------------------------------------------------------------------------
+double StemCache::getHitRate() const {
+  uint64_t hits = getHits();
+  uint64_t lookups = hits + getMisses();
+  return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+}
+//---------------------------------------------------------------------------
+void StemCache::resetStatistics() {
+  for (size_t i = 0; i < kNumShards; ++i) {
+    std::unique_lock lck(shards[i].lock);
+    shards[i].hits = 0;
+    shards[i].misses = 0;
+  }
+}
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
@@ -0,0 +1,82 @@
+#ifndef STEM_CACHE_HPP
+#define STEM_CACHE_HPP
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+//---------------------------------------------------------------------------
+#include "utils.hpp"
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+/**
+ * A bounded, concurrent cache mapping lower-cased surface forms to their stems.
+ *
+ * The cache is split into shards, each guarded by its own spin lock. A shard is a
+ * direct-mapped table: an insert simply overwrites whatever occupied the slot before,
+ * so the memory stays bounded without any eviction bookkeeping.
+ */
+class StemCache {
+ public:
+  /// The default number of cached surface forms.
+  static constexpr size_t kDefaultCapacity = 1 << 16;
+  /// Surface forms longer than this are neither cached nor looked up.
+  static constexpr size_t kMaxTokenLength = 32;
+
+  /// Constructor.
+  explicit StemCache(size_t capacity = kDefaultCapacity);
+  /// Copy Constructor.
+  StemCache(const StemCache&) = delete;
+  /// Copy assigment.
+  StemCache& operator=(const StemCache&) = delete;
+
+  /// @brief Looks up the stem of given surface form.
+  /// @param surface The lower-cased surface form.
+  /// @param stem Receives the stem on a hit.
+  /// @return True if the surface form was cached.
+  bool lookup(std::string_view surface, std::string& stem);
+  /// Caches the stem of given surface form, replacing the slot's previous entry.
+  void insert(std::string_view surface, std::string_view stem);
+
+  /// Get the number of lookups answered from the cache.
+  [[nodiscard]] uint64_t getHits() const;
+  /// Get the number of lookups that had to fall back to the stemmer.
+  [[nodiscard]] uint64_t getMisses() const;
+  /// Get the share of lookups answered from the cache.
+  [[nodiscard]] double getHitRate() const;
+  /// Reset the hit and miss counters.
+  void resetStatistics();
+
+ private:
+  struct Entry {
+    /// The cached surface form. Empty if the slot is unused.
+    std::string surface;
+    /// The surface form's stem.
+    std::string stem;
+  };
+  /// A shard is padded to a cache line to avoid false sharing between the locks.
+  struct alignas(64) Shard {
+    /// The shard's slots.
+    std::vector<Entry> entries;
+    /// Guards the entries and the counters.
+    utils::SpinLock lock;
+    /// The number of hits in this shard.
+    uint64_t hits = 0;
+    /// The number of misses in this shard.
+    uint64_t misses = 0;
+  };
+
+  /// The number of shards, a power of two.
+  static constexpr size_t kNumShards = 64;
+
+  /// The shards.
+  std::unique_ptr<Shard[]> shards;
+  /// The mask to map a hash onto a slot within a shard.
+  uint64_t slot_mask;
+};
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // STEM_CACHE_HPP
@@ -0,0 +1,27 @@
+#include "stemmer.hpp"
+//---------------------------------------------------------------------------
+#include "snowball/api.h"
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+Stemmer::Stemmer(StemCache *cache) : env(english_UTF_8_create_env()), cache(cache) {}
+//---------------------------------------------------------------------------
+Stemmer::~Stemmer() { english_UTF_8_close_env(env); }
+//---------------------------------------------------------------------------
+std::string_view Stemmer::stem(std::string_view token) {
+  if (cache && cache->lookup(token, cached_stem)) {
+    return cached_stem;
+  }
+
+  SN_set_current(env, static_cast<int>(token.size()),
+                 reinterpret_cast<const unsigned char *>(token.data()));
+  english_UTF_8_stem(env);
+  std::string_view stem(reinterpret_cast<const char *>(env->p), env->l);
+
+  if (cache) {
+    cache->insert(token, stem);
+  }
+  return stem;
+}
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
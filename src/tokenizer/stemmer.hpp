@@ -0,0 +1,49 @@
+#ifndef STEMMER_HPP
+#define STEMMER_HPP
+//---------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+//---------------------------------------------------------------------------
+#include "stem_cache.hpp"
+//---------------------------------------------------------------------------
+struct SN_env;
+extern "C" {
+SN_env *english_UTF_8_create_env();
+void english_UTF_8_close_env(SN_env *);
+int english_UTF_8_stem(SN_env *);
+int SN_set_current(SN_env *, int, const unsigned char *);
+}
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+/**
+ * Wraps a Snowball English stemmer environment, optionally memoizing stems in a
+ * shared StemCache. Not threadsafe, every thread needs its own instance.
+ */
+class Stemmer {
+ public:
+  /// Constructor. Stems are memoized in given cache, if any.
+  explicit Stemmer(StemCache *cache = nullptr);
+  /// Destructor.
+  ~Stemmer();
+  /// Copy Constructor.
+  Stemmer(const Stemmer &) = delete;
+  /// Copy assigment.
+  Stemmer &operator=(const Stemmer &) = delete;
+
+  /// @brief Stems given lower-cased token.
+  /// @return The stem, valid until the next call.
+  std::string_view stem(std::string_view token);
+
+ private:
+  /// The Snowball environment.
+  SN_env *env;
+  /// The stem cache, nullptr if disabled.
+  StemCache *cache;
+  /// Receives stems found in the cache.
+  std::string cached_stem;
+};
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // STEMMER_HPP
@@ -5,20 +5,16 @@
 #include <string>
 
 #include "ITokenizer.hpp"
+#include "stem_cache.hpp"
+#include "stemmer.hpp"
 
-struct SN_env;
-extern "C" {
-SN_env *english_UTF_8_create_env();
-void english_UTF_8_close_env(SN_env *);
-int english_UTF_8_stem(SN_env *);
-int SN_set_current(SN_env *, int, const unsigned char *);
-}
 namespace tokenizer {
 
 class StemmingTokenizer : public ITokenizer {
  public:
-  StemmingTokenizer(const char *data, size_t size);
-  ~StemmingTokenizer() override;
+  /// Constructor. Stems are memoized in given cache, if any.
+  StemmingTokenizer(const char *data, size_t size, StemCache *cache = nullptr);
+  ~StemmingTokenizer() override = default;
 
   std::string nextToken(bool skip_stop_words) override;
 
@@ -28,7 +24,7 @@ class StemmingTokenizer : public ITokenizer {
   const char *data_;
   size_t size_;
   size_t currentPos_;
-  SN_env *stemEnv_;
+  Stemmer stemmer_;
 };
 }  // namespace tokenizer
 #endif  // STEMMINGTOKENIZER_HPP
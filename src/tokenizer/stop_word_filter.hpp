@@ -0,0 +1,97 @@
+#ifndef STOP_WORD_FILTER_HPP
+#define STOP_WORD_FILTER_HPP
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+/**
+ * A perfect hash set over a fixed list of words, built entirely at compile time.
+ *
+ * A word is reduced to a 64-bit key made of its first and last eight bytes and
+ * its length. The builder searches a multiplier that maps all keys of the list
+ * onto distinct slots, so a lookup costs one multiply, one table load and at most
+ * one string comparison, without any allocation.
+ */
+template <size_t N>
+class StopWordFilter {
+ public:
+  /// Constructor. Fails to compile if no perfect multiplier is found.
+  consteval explicit StopWordFilter(const std::array<std::string_view, N>& words)
+      : words(words), slots{}, multiplier(0), max_length(0) {
+    for (auto word : words) {
+      max_length = std::max(max_length, word.size());
+    }
+    for (uint64_t attempt = 0; attempt < kMaxAttempts; ++attempt) {
+      // Odd multipliers spread over the 64-bit range.
+      multiplier = (0x9E3779B97F4A7C15ull * (attempt + 1)) | 1;
+      if (tryBuild()) return;
+    }
+    throw std::logic_error("No perfect hash found for the stop word list");
+  }
+
+  /// Whether given lower-cased word is part of the list.
+  [[nodiscard]] constexpr bool contains(std::string_view word) const {
+    if (word.empty() || word.size() > max_length) return false;
+    Slot slot = slots[slotOf(word)];
+    return slot != 0 && words[slot - 1] == word;
+  }
+
+ private:
+  /// A slot stores the index of its word plus one, zero marks an empty slot.
+  using Slot = std::conditional_t<(N < 0xFF), uint8_t, uint16_t>;
+  /// The table has N^2 / 8 to N^2 / 4 slots, so a random multiplier is perfect with a
+  /// probability between e^-4 and e^-2, and the default table fits in 4 KiB.
+  static constexpr size_t kNumSlots = std::bit_ceil(std::max<size_t>(64, N * N / 8));
+  static constexpr int kSlotBits = std::countr_zero(kNumSlots);
+  static constexpr uint64_t kMaxAttempts = 4096;
+
+  /// Reads up to eight bytes little-endian into an integer.
+  static constexpr uint64_t load(const char* data, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+      value |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return value;
+  }
+  /// Reduces a word to its first and last eight bytes and its length.
+  static constexpr uint64_t key(std::string_view word) {
+    size_t size = word.size();
+    uint64_t head = load(word.data(), std::min<size_t>(size, 8));
+    uint64_t tail = size > 8 ? load(word.data() + size - 8, 8) : 0;
+    return head ^ std::rotl(tail, 31) ^ (static_cast<uint64_t>(size) << 56);
+  }
+  /// The slot of given word.
+  [[nodiscard]] constexpr size_t slotOf(std::string_view word) const {
+    return static_cast<size_t>((key(word) * multiplier) >> (64 - kSlotBits));
+  }
+  /// Fills the slots with the current multiplier, false on a collision.
+  constexpr bool tryBuild() {
+    slots.fill(0);
+    for (size_t i = 0; i < N; ++i) {
+      auto& slot = slots[slotOf(words[i])];
+      if (slot != 0) return false;
+      slot = static_cast<Slot>(i + 1);
+    }
+    return true;
+  }
+
+  /// The words of the set.
+  std::array<std::string_view, N> words;
+  /// The hash table.
+  std::array<Slot, kNumSlots> slots;
+  /// The perfect multiplier.
+  uint64_t multiplier;
+  /// The length of the longest word, longer words are rejected upfront.
+  size_t max_length;
+};
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // STOP_WORD_FILTER_HPP
@@ -0,0 +1,174 @@
+#include "utf8.hpp"
+//---------------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+//---------------------------------------------------------------------------
+#include "tokenizer_rules.hpp"
+//---------------------------------------------------------------------------
+namespace tokenizer::utf8 {
+//---------------------------------------------------------------------------
+namespace {
+//---------------------------------------------------------------------------
+/// An inclusive range of code points.
+struct Range {
+  char32_t first;
+  char32_t last;
+};
+//---------------------------------------------------------------------------
+/// The non-ASCII letters, combining marks and decimal digits, sorted and disjoint.
+constexpr Range kWordRanges[] = {
+    {0x00AA, 0x00AA},   {0x00B5, 0x00B5},   {0x00BA, 0x00BA},   {0x00C0, 0x00D6},
+    {0x00D8, 0x00F6},   {0x00F8, 0x02C1},   {0x02C6, 0x02D1},   {0x02E0, 0x02E4},
+    {0x02EC, 0x02EC},   {0x02EE, 0x02EE},   {0x0300, 0x0374},   {0x0376, 0x037D},
+    {0x037F, 0x037F},   {0x0386, 0x0386},   {0x0388, 0x03F5},   {0x03F7, 0x0481},
+    {0x0483, 0x052F},   {0x0531, 0x0556},   {0x0559, 0x0559},   {0x0560, 0x0588},
+    {0x0591, 0x05BD},   {0x05BF, 0x05BF},   {0x05C1, 0x05C2},   {0x05C4, 0x05C5},
+    {0x05C7, 0x05C7},   {0x05D0, 0x05EA},   {0x05EF, 0x05F2},   {0x0610, 0x061A},
+    {0x0620, 0x0669},   {0x066E, 0x06D3},   {0x06D5, 0x06DC},   {0x06DF, 0x06E8},
+    {0x06EA, 0x06FC},   {0x06FF, 0x06FF},   {0x0710, 0x074A},   {0x074D, 0x07B1},
+    {0x07C0, 0x07F5},   {0x0900, 0x0963},   {0x0966, 0x096F},   {0x0971, 0x0DF3},
+    {0x0E01, 0x0E3A},   {0x0E40, 0x0E4E},   {0x0E50, 0x0E59},   {0x0E81, 0x0EDF},
+    {0x0F00, 0x0F00},   {0x0F18, 0x0F19},   {0x0F20, 0x0F29},   {0x0F40, 0x0FBC},
+    {0x1000, 0x1049},   {0x1050, 0x109D},   {0x10A0, 0x10FA},   {0x10FC, 0x135A},
+    {0x1380, 0x138F},   {0x13A0, 0x13FD},   {0x1401, 0x166C},   {0x166F, 0x167F},
+    {0x1681, 0x169A},   {0x16A0, 0x16EA},   {0x1700, 0x17D3},   {0x17E0, 0x17E9},
+    {0x1820, 0x18AA},   {0x1E00, 0x1FBC},   {0x1FBE, 0x1FBE},   {0x1FC2, 0x1FCC},
+    {0x1FD0, 0x1FDB},   {0x1FE0, 0x1FEC},   {0x1FF2, 0x1FFC},   {0x2071, 0x2071},
+    {0x207F, 0x207F},   {0x2090, 0x209C},   {0x2C00, 0x2CE4},   {0x2D00, 0x2D25},
+    {0x2D30, 0x2D67},   {0x3005, 0x3007},   {0x3041, 0x3096},   {0x3099, 0x309F},
+    {0x30A1, 0x30FF},   {0x3105, 0x312F},   {0x3131, 0x318E},   {0x31A0, 0x31BF},
+    {0x31F0, 0x31FF},   {0x3400, 0x4DBF},   {0x4E00, 0xA48C},   {0xA4D0, 0xA4FD},
+    {0xA500, 0xA60C},   {0xA610, 0xA62B},   {0xA640, 0xA66F},   {0xA680, 0xA69D},
+    {0xAC00, 0xD7A3},   {0xF900, 0xFAFF},   {0xFB00, 0xFB06},   {0xFB13, 0xFB17},
+    {0xFB1D, 0xFB28},   {0xFB2A, 0xFBB1},   {0xFE70, 0xFEFC},   {0xFF10, 0xFF19},
+    {0xFF21, 0xFF3A},   {0xFF41, 0xFF5A},   {0xFF66, 0xFFDC},   {0x10000, 0x100FA},
+    {0x10300, 0x1034A}, {0x10400, 0x1049D}, {0x20000, 0x2FA1D}, {0x30000, 0x3134A},
+};
+//---------------------------------------------------------------------------
+/// Upper-case letters in [first, last] fold to cp + delta. With a stride of two only
+/// every other code point starting at first is upper-case (alternating case blocks).
+struct FoldRange {
+  char32_t first;
+  char32_t last;
+  int32_t delta;
+  uint32_t stride;
+};
+//---------------------------------------------------------------------------
+/// The simple case folding of the non-ASCII scripts, sorted and disjoint.
+constexpr FoldRange kFoldRanges[] = {
+    {0x00C0, 0x00D6, 32, 1},   {0x00D8, 0x00DE, 32, 1},   {0x0100, 0x012E, 1, 2},
+    {0x0132, 0x0136, 1, 2},    {0x0139, 0x0147, 1, 2},    {0x014A, 0x0176, 1, 2},
+    {0x0178, 0x0178, -121, 1}, {0x0179, 0x017D, 1, 2},    {0x01CD, 0x01DB, 1, 2},
+    {0x01DE, 0x01EE, 1, 2},    {0x01F8, 0x021E, 1, 2},    {0x0222, 0x0232, 1, 2},
+    {0x0386, 0x0386, 38, 1},   {0x0388, 0x038A, 37, 1},   {0x038C, 0x038C, 64, 1},
+    {0x038E, 0x038F, 63, 1},   {0x0391, 0x03A1, 32, 1},   {0x03A3, 0x03AB, 32, 1},
+    {0x03D8, 0x03EE, 1, 2},    {0x0400, 0x040F, 80, 1},   {0x0410, 0x042F, 32, 1},
+    {0x0460, 0x0480, 1, 2},    {0x048A, 0x04BE, 1, 2},    {0x04C1, 0x04CD, 1, 2},
+    {0x04D0, 0x052E, 1, 2},    {0x0531, 0x0556, 48, 1},   {0x10A0, 0x10C5, 7264, 1},
+    {0x1E00, 0x1E94, 1, 2},    {0x1EA0, 0x1EFE, 1, 2},    {0xFF21, 0xFF3A, 32, 1},
+};
+//---------------------------------------------------------------------------
+/// The range of given table ending at or after cp, or nullptr if there is none.
+template <typename T, size_t N>
+const T *findRange(const T (&table)[N], char32_t cp) {
+  auto it = std::lower_bound(std::begin(table), std::end(table), cp,
+                             [](const T &range, char32_t value) { return range.last < value; });
+  return it == std::end(table) ? nullptr : it;
+}
+//---------------------------------------------------------------------------
+}  // namespace
+//---------------------------------------------------------------------------
+char32_t decode(const char *&it, const char *end) {
+  auto lead = static_cast<uint8_t>(*it++);
+  if (lead < 0x80) return lead;
+
+  size_t length;
+  char32_t cp;
+  char32_t min;
+  if ((lead & 0xE0) == 0xC0) {
+    length = 1, cp = lead & 0x1F, min = 0x80;
+  } else if ((lead & 0xF0) == 0xE0) {
+    length = 2, cp = lead & 0x0F, min = 0x800;
+  } else if ((lead & 0xF8) == 0xF0) {
+    length = 3, cp = lead & 0x07, min = 0x10000;
+  } else {
+    return kReplacement;
+  }
+  if (static_cast<size_t>(end - it) < length) return kReplacement;
+
+  for (size_t i = 0; i < length; ++i) {
+    auto c = static_cast<uint8_t>(it[i]);
+    if ((c & 0xC0) != 0x80) return kReplacement;
+    cp = (cp << 6) | (c & 0x3F);
+  }
+  // Overlong encodings, surrogates and values beyond the Unicode range.
+  if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return kReplacement;
+
+  it += length;
+  return cp;
+}
+//---------------------------------------------------------------------------
+void encode(char32_t cp, std::string &out) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+//---------------------------------------------------------------------------
+bool isWordChar(char32_t cp) {
+  if (cp < 0x80) return !isDelimiter(static_cast<char>(cp));
+  const Range *range = findRange(kWordRanges, cp);
+  return range != nullptr && range->first <= cp;
+}
+//---------------------------------------------------------------------------
+char32_t foldCase(char32_t cp) {
+  if (cp < 0x80) return (cp >= 'A' && cp <= 'Z') ? cp + ('a' - 'A') : cp;
+  const FoldRange *range = findRange(kFoldRanges, cp);
+  if (range == nullptr || range->first > cp || (cp - range->first) % range->stride != 0) {
+    return cp;
+  }
+  return static_cast<char32_t>(static_cast<int32_t>(cp) + range->delta);
+}
+//---------------------------------------------------------------------------
+const char *findWordBegin(const char *it, const char *end) {
+  while (it < end) {
+    if (static_cast<uint8_t>(*it) < 0x80) {
+      if (!isDelimiter(*it)) return it;
+      ++it;
+      continue;
+    }
+    const char *cp_begin = it;
+    if (isWordChar(decode(it, end))) return cp_begin;
+  }
+  return end;
+}
+//---------------------------------------------------------------------------
+const char *appendFoldedWord(const char *it, const char *end, std::string &out) {
+  while (it < end) {
+    auto c = static_cast<uint8_t>(*it);
+    if (c < 0x80) {
+      if (isDelimiter(static_cast<char>(c))) break;
+      out.push_back(static_cast<char>(foldCase(c)));
+      ++it;
+      continue;
+    }
+    const char *cp_begin = it;
+    char32_t cp = decode(it, end);
+    if (!isWordChar(cp)) return cp_begin;
+    encode(foldCase(cp), out);
+  }
+  return it;
+}
+//---------------------------------------------------------------------------
+}  // namespace tokenizer::utf8
@@ -0,0 +1,45 @@
+#ifndef UTF8_HPP
+#define UTF8_HPP
+//---------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <string>
+//---------------------------------------------------------------------------
+namespace tokenizer {
+//---------------------------------------------------------------------------
+/**
+ * The slow path of Unicode-aware tokenization.
+ *
+ * A word consists of the ASCII token characters (see DELIM_CHARS) and of the
+ * letters, combining marks and decimal digits of the other scripts. Words are
+ * normalized with the simple (one-to-one) Unicode case folding. The tables cover
+ * the Latin, Greek, Cyrillic, Armenian, Georgian, Hebrew, Arabic, Indic,
+ * South-East Asian and CJK blocks; code points outside of them are delimiters.
+ *
+ * Invalid UTF-8 sequences decode to U+FFFD one byte at a time, so every input
+ * can be scanned without failing.
+ */
+namespace utf8 {
+//---------------------------------------------------------------------------
+/// The replacement character for invalid sequences.
+constexpr char32_t kReplacement = 0xFFFD;
+//---------------------------------------------------------------------------
+/// Decodes the code point at it and advances it past it. Requires it < end.
+char32_t decode(const char *&it, const char *end);
+/// Appends the UTF-8 encoding of given code point to out.
+void encode(char32_t cp, std::string &out);
+/// Whether given code point belongs to a word.
+bool isWordChar(char32_t cp);
+/// The simple case folding of given code point.
+char32_t foldCase(char32_t cp);
+//---------------------------------------------------------------------------
+/// Returns the begin of the first word in [it, end), or end.
+const char *findWordBegin(const char *it, const char *end);
+/// Appends the case-folded word starting at it to out, returns the end of the word.
+const char *appendFoldedWord(const char *it, const char *end, std::string &out);
+//---------------------------------------------------------------------------
+}  // namespace utf8
+//---------------------------------------------------------------------------
+}  // namespace tokenizer
+//---------------------------------------------------------------------------
+#endif  // UTF8_HPP
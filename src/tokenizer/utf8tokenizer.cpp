@@ -0,0 +1,41 @@
+#include "utf8tokenizer.hpp"
+
+#include "simd_scan.hpp"
+#include "tokenizer_rules.hpp"
+#include "utf8.hpp"
+namespace tokenizer {
+
+Utf8Tokenizer::Utf8Tokenizer(const char *data, size_t size, bool stem, StemCache *cache)
+    : it_(data), end_(data + size), ascii_(isAscii(data, size)), stem_(stem), stemmer_(cache) {
+  tokenBuffer_.reserve(128);
+}
+
+std::string Utf8Tokenizer::nextToken(bool skip_stop_words) {
+  while (true) {
+    if (ascii_) {
+      it_ = findTokenBegin(it_, end_);
+      if (it_ >= end_) {
+        return "";
+      }
+      const char *token_end = findTokenEnd(it_, end_);
+      tokenBuffer_.resize(token_end - it_);
+      toLower(it_, tokenBuffer_.size(), tokenBuffer_.data());
+      it_ = token_end;
+    } else {
+      it_ = utf8::findWordBegin(it_, end_);
+      if (it_ >= end_) {
+        return "";
+      }
+      tokenBuffer_.clear();
+      it_ = utf8::appendFoldedWord(it_, end_, tokenBuffer_);
+    }
+
+    if (skip_stop_words && isStopWord(tokenBuffer_)) {
+      continue;
+    }
+
+    return stem_ ? std::string(stemmer_.stem(tokenBuffer_)) : tokenBuffer_;
+  }
+}
+
+}  // namespace tokenizer
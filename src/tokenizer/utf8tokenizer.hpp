@@ -0,0 +1,38 @@
+#ifndef UTF8TOKENIZER_HPP
+#define UTF8TOKENIZER_HPP
+
+#include <string>
+
+#include "ITokenizer.hpp"
+#include "stem_cache.hpp"
+#include "stemmer.hpp"
+
+namespace tokenizer {
+
+/**
+ * Tokenizes UTF-8 text, keeping the letters of non-Latin scripts and folding their case.
+ *
+ * Texts without any byte >= 128 take the same SIMD path as SimpleTokenizer and
+ * StemmingTokenizer and yield the same tokens; all other texts are decoded code
+ * point by code point (see utf8.hpp).
+ */
+class Utf8Tokenizer : public ITokenizer {
+ public:
+  /// Constructor. Stems the tokens if stem is set, memoizing them in given cache, if any.
+  Utf8Tokenizer(const char *data, size_t size, bool stem, StemCache *cache = nullptr);
+  ~Utf8Tokenizer() override = default;
+
+  std::string nextToken(bool skip_stop_words) override;
+
+ private:
+  const char *it_;
+  const char *end_;
+  /// Whether the text is pure ASCII.
+  bool ascii_;
+  bool stem_;
+  Stemmer stemmer_;
+
+  std::string tokenBuffer_;
+};
+}  // namespace tokenizer
+#endif  // UTF8TOKENIZER_HPP
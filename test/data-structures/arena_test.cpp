@@ -0,0 +1,47 @@
+#include "data-structures/arena.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ArenaTest, AlignsAndPacksAllocations) {
+  Arena arena(4096);
+  auto* first = static_cast<char*>(arena.allocate(3, 1));
+  auto* second = static_cast<char*>(arena.allocate(8, 8));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(second) % 8, 0u);
+  EXPECT_LE(second - first, 8);
+  EXPECT_EQ(arena.footprint(), 4096u);
+
+  // Large allocations are mapped on their own and unmapped on deallocation
+  void* large = arena.allocate(5000, 64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % 64, 0u);
+  EXPECT_EQ(arena.footprint(), 3 * 4096u);
+  arena.deallocate(large, 5000, 64);
+  EXPECT_EQ(arena.footprint(), 4096u);
+  EXPECT_NE(arena.allocate(5000, 16), nullptr);
+
+  arena.release();
+  EXPECT_EQ(arena.footprint(), 0u);
+}
+
+TEST(ArenaTest, BacksPmrContainersOfSeveralThreads) {
+  Arena arena(1 << 12);
+  std::vector<std::pmr::vector<uint64_t>> vectors;
+  for (int i = 0; i < 4; ++i) vectors.emplace_back(&arena);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&vectors, i]() {
+      for (uint64_t value = 0; value < 10000; ++value) vectors[i].push_back(value * i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(vectors[i].size(), 10000u);
+    for (uint64_t value = 0; value < 10000; ++value) EXPECT_EQ(vectors[i][value], value * i);
+  }
+}
@@ -0,0 +1,53 @@
+#include "data-structures/chunked_list.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "data-structures/arena.hpp"
+
+TEST(ChunkedListTest, KeepsInsertionOrderAcrossChunks) {
+  Arena arena;
+  ChunkedList<std::pair<uint32_t, uint32_t>> list;
+  EXPECT_TRUE(list.empty());
+  for (uint32_t i = 0; i < 5000; ++i) list.push_back({i, i * 2}, arena);
+  EXPECT_EQ(list.size(), 5000u);
+
+  std::vector<std::pair<uint32_t, uint32_t>> values = {{7, 7}};
+  list.appendTo(values);
+  ASSERT_EQ(values.size(), 5001u);
+  EXPECT_EQ(values.capacity(), values.size());
+  EXPECT_EQ(values[0], (std::pair<uint32_t, uint32_t>{7, 7}));
+  for (uint32_t i = 0; i < 5000; ++i) {
+    EXPECT_EQ(values[i + 1], (std::pair<uint32_t, uint32_t>{i, i * 2}));
+  }
+
+  list.clear(arena);
+  EXPECT_EQ(list.size(), 0u);
+  list.push_back({1, 1}, arena);
+  EXPECT_EQ(list.size(), 1u);
+}
+
+TEST(ChunkedListTest, ShortListsUseOneSmallChunk) {
+  Arena arena(1 << 16);
+  std::vector<ChunkedList<uint32_t>> lists(1000);
+  for (auto& list : lists) list.push_back(1, arena);
+  // One chunk of kMinChunkBytes per list
+  EXPECT_EQ(arena.footprint(), uint64_t{1} << 16);
+
+  std::vector<uint32_t> values;
+  lists[0].appendTo(values);
+  EXPECT_EQ(values, std::vector<uint32_t>{1});
+}
+
+TEST(ChunkedListTest, ClearFreesLargeChunks) {
+  Arena arena(1 << 12);
+  ChunkedList<uint64_t> list;
+  for (uint64_t i = 0; i < 10000; ++i) list.push_back(i, arena);
+  uint64_t footprint = arena.footprint();
+  list.clear(arena);
+  // Only the small chunks stay with the arena
+  EXPECT_LT(arena.footprint(), footprint / 4);
+}
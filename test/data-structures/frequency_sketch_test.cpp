@@ -0,0 +1,36 @@
+#include "data-structures/frequency_sketch.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(FrequencySketchTest, NeverUndercounts) {
+  FrequencySketch sketch(1024);
+  for (uint32_t i = 0; i < 500; ++i) {
+    for (uint32_t j = 0; j <= i % 5; ++j) sketch.add(std::to_string(i));
+  }
+
+  for (uint32_t i = 0; i < 500; ++i) {
+    EXPECT_GE(sketch.estimate(std::to_string(i)), i % 5 + 1);
+  }
+  EXPECT_EQ(sketch.estimate("unseen"), 0u);
+}
+
+TEST(FrequencySketchTest, SaturatesInsteadOfOverflowing) {
+  FrequencySketch sketch(1024);
+  for (uint32_t i = 0; i < 300; ++i) sketch.add("hot");
+
+  EXPECT_EQ(sketch.estimate("hot"), 255u);
+}
+
+TEST(FrequencySketchTest, AgingHalvesTheCounts) {
+  // 16 counters per row, so all counters are halved after 160 additions
+  FrequencySketch sketch(16);
+  for (uint32_t i = 0; i < 100; ++i) sketch.add("old");
+  uint32_t before = sketch.estimate("old");
+  for (uint32_t i = 0; i < 60; ++i) sketch.add("new");
+
+  EXPECT_GE(before, 100u);
+  EXPECT_LE(sketch.estimate("old"), (before + 60) / 2);
+  EXPECT_GE(sketch.estimate("old"), 50u);
+}
@@ -0,0 +1,89 @@
+#include "data-structures/packed_postings.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Posting = std::pair<uint32_t, uint32_t>;
+
+}  // namespace
+
+TEST(PackedPostingsTest, FindsTheListsOfAllKeys) {
+  PackedPostings<std::string, Posting> packed;
+  EXPECT_EQ(packed.find(std::string("apple")), packed.kNotFound);
+  for (uint32_t i = 0; i < 1000; ++i) {
+    std::vector<Posting> postings(i % 7, {i, i * 2});
+    EXPECT_EQ(packed.add("token" + std::to_string(i), postings), i);
+  }
+  EXPECT_EQ(packed.size(), 1000u);
+
+  uint64_t num_postings = 0;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    uint32_t index = packed.find("token" + std::to_string(i));
+    ASSERT_EQ(index, i);
+    EXPECT_EQ(packed.key(index), "token" + std::to_string(i));
+    std::span<const Posting> postings = packed.postings(index);
+    EXPECT_EQ(postings.size(), i % 7);
+    for (const auto& posting : postings) EXPECT_EQ(posting, (Posting{i, i * 2}));
+    num_postings += i % 7;
+  }
+  EXPECT_EQ(packed.getPostingCount(), num_postings);
+  EXPECT_EQ(packed.find(std::string("token1000")), packed.kNotFound);
+}
+
+TEST(PackedPostingsTest, WritesReservedListsInPlace) {
+  PackedPostings<uint32_t, uint32_t> packed;
+  packed.reserve(100);
+  uint32_t first = packed.add(5, 60);
+  uint32_t* data = packed.postings(first).data();
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % packed.kCacheLineSize, 0u);
+  uint32_t second = packed.add(9, 40);
+  // Within the reservation the buffer isn't moved and the lists are adjacent
+  EXPECT_EQ(packed.postings(first).data(), data);
+  EXPECT_EQ(packed.postings(second).data(), data + 60);
+  EXPECT_EQ(packed.postings(second).size(), 40u);
+
+  std::span<uint32_t> postings = packed.postings(second);
+  for (uint32_t i = 0; i < postings.size(); ++i) postings[i] = i;
+  packed.add(3, std::vector<uint32_t>(200, 1));
+  EXPECT_EQ(packed.postings(packed.find(9u))[39], 39u);
+  EXPECT_EQ(packed.getPostingCount(), 300u);
+}
+
+TEST(PackedPostingsTest, RemovesPostingsInPlace) {
+  PackedPostings<uint32_t, Posting> packed;
+  packed.add(1, std::vector<Posting>{{1, 1}, {2, 1}, {3, 1}});
+  packed.add(2, std::vector<Posting>{{2, 5}});
+  packed.add(3, std::vector<Posting>{{1, 2}, {4, 2}});
+
+  uint64_t removed = packed.removeIf([](uint32_t index, const Posting& posting) {
+    return posting.first == 2 || (index == 2 && posting.first == 4);
+  });
+  EXPECT_EQ(removed, 3u);
+  EXPECT_EQ(packed.getPostingCount(), 3u);
+  EXPECT_EQ(packed.size(), 3u);
+  auto first = packed.postings(packed.find(1u));
+  EXPECT_EQ(std::vector<Posting>(first.begin(), first.end()),
+            (std::vector<Posting>{{1, 1}, {3, 1}}));
+  EXPECT_TRUE(packed.postings(packed.find(2u)).empty());
+  auto third = packed.postings(packed.find(3u));
+  EXPECT_EQ(std::vector<Posting>(third.begin(), third.end()), (std::vector<Posting>{{1, 2}}));
+}
+
+TEST(PackedPostingsTest, MovesAllLists) {
+  PackedPostings<uint32_t, Posting> packed;
+  packed.add(7, std::vector<Posting>{{1, 1}});
+  PackedPostings<uint32_t, Posting> moved(std::move(packed));
+  EXPECT_EQ(moved.postings(moved.find(7u)).front(), (Posting{1, 1}));
+  EXPECT_EQ(packed.find(7u), packed.kNotFound);
+  EXPECT_EQ(packed.getPostingCount(), 0u);
+
+  packed.add(8, 1);
+  EXPECT_EQ(packed.find(8u), 0u);
+}
@@ -0,0 +1,68 @@
+#include "data-structures/sorted_runs.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Posting = std::pair<uint32_t, uint32_t>;
+using Entries = std::vector<std::pair<std::string, std::vector<Posting>>>;
+
+}  // namespace
+
+TEST(SortedRunsTest, MergesKeysOfAllRunsInOrder) {
+  SortedRuns<std::string, Posting> runs(std::filesystem::temp_directory_path());
+  Entries first = {{"pear", {{1, 2}}}, {"apple", {{1, 1}, {2, 3}}}};
+  Entries second = {{"apple", {{5, 1}}}, {"fig", {{4, 4}}}};
+  runs.write(first);
+  runs.write(second);
+  EXPECT_EQ(runs.size(), 2u);
+
+  Entries merged;
+  runs.merge([&](const std::string& key, const std::vector<Posting>& postings) {
+    merged.emplace_back(key, postings);
+  });
+  Entries expected = {{"apple", {{1, 1}, {2, 3}, {5, 1}}}, {"fig", {{4, 4}}}, {"pear", {{1, 2}}}};
+  EXPECT_EQ(merged, expected);
+}
+
+TEST(SortedRunsTest, MatchesInMemoryGrouping) {
+  std::map<uint32_t, std::vector<uint32_t>> expected;
+  SortedRuns<uint32_t, uint32_t> runs(std::filesystem::temp_directory_path());
+  for (uint32_t run = 0; run < 5; ++run) {
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> entries;
+    for (uint32_t key = run; key < 1000; key += run + 1) {
+      entries.push_back({key * 7919 % 1000, {run, key}});
+      expected[key * 7919 % 1000].insert(expected[key * 7919 % 1000].end(), {run, key});
+    }
+    runs.write(entries);
+  }
+
+  std::map<uint32_t, std::vector<uint32_t>> merged;
+  uint32_t previous = 0;
+  runs.merge([&](uint32_t key, const std::vector<uint32_t>& postings) {
+    EXPECT_TRUE(merged.empty() || key > previous);
+    previous = key;
+    merged[key] = postings;
+  });
+  EXPECT_EQ(merged, expected);
+  EXPECT_GT(runs.getBytesWritten(), 0u);
+}
+
+TEST(SortedRunsTest, RemovesItsFiles) {
+  std::filesystem::path directory = std::filesystem::temp_directory_path() / "sorted_runs_test";
+  std::filesystem::create_directories(directory);
+  {
+    SortedRuns<uint32_t, uint32_t> runs(directory);
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> entries = {{1, {2}}};
+    runs.write(entries);
+    EXPECT_FALSE(std::filesystem::is_empty(directory));
+  }
+  EXPECT_TRUE(std::filesystem::is_empty(directory));
+  std::filesystem::remove(directory);
+}
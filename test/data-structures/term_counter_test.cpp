@@ -0,0 +1,56 @@
+#include "data-structures/term_counter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(TermCounterTest, CountsInInsertionOrder) {
+  TermCounter counter;
+  for (std::string_view term : {"run", "fast", "run", "far", "run", "fast"}) {
+    counter.add(term);
+  }
+
+  std::vector<std::pair<std::string_view, uint32_t>> counts;
+  for (const auto& [term, count] : counter) counts.emplace_back(term, count);
+  EXPECT_EQ(counts, (std::vector<std::pair<std::string_view, uint32_t>>{
+                        {"run", 3}, {"fast", 2}, {"far", 1}}));
+}
+
+TEST(TermCounterTest, ClearForgetsAllTerms) {
+  TermCounter counter(4);
+  counter.add("a");
+  counter.add("b");
+  counter.clear();
+  EXPECT_EQ(counter.size(), 0);
+
+  counter.add("b");
+  ASSERT_EQ(counter.size(), 1);
+  EXPECT_EQ(counter.begin()->term, "b");
+  EXPECT_EQ(counter.begin()->count, 1);
+}
+
+TEST(TermCounterTest, MatchesMapAcrossGrowthAndReuse) {
+  std::vector<std::string> vocabulary;
+  for (int i = 0; i < 1000; ++i) vocabulary.push_back("term" + std::to_string(i));
+
+  std::mt19937 gen(42);
+  TermCounter counter(1);
+  for (int doc = 0; doc < 20; ++doc) {
+    std::map<std::string_view, uint32_t> expected;
+    counter.clear();
+    size_t distinct = 1 + gen() % vocabulary.size();
+    for (int i = 0; i < 3000; ++i) {
+      std::string_view term = vocabulary[gen() % distinct];
+      counter.add(term);
+      ++expected[term];
+    }
+
+    std::map<std::string_view, uint32_t> actual;
+    for (const auto& [term, count] : counter) actual[term] = count;
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(counter.size(), expected.size());
+  }
+}
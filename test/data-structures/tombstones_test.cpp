@@ -0,0 +1,45 @@
+#include "data-structures/tombstones.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(TombstonesTest, EraseAndRevive) {
+  Tombstones tombstones(100);
+
+  EXPECT_TRUE(tombstones.erase(3));
+  EXPECT_TRUE(tombstones.erase(64));
+  EXPECT_FALSE(tombstones.erase(3));
+  EXPECT_TRUE(tombstones.contains(3));
+  EXPECT_TRUE(tombstones.contains(64));
+  EXPECT_FALSE(tombstones.contains(4));
+  EXPECT_EQ(tombstones.count(), 2u);
+
+  EXPECT_TRUE(tombstones.revive(3));
+  EXPECT_FALSE(tombstones.revive(3));
+  EXPECT_FALSE(tombstones.contains(3));
+  EXPECT_EQ(tombstones.count(), 1u);
+}
+
+TEST(TombstonesTest, IdsBeyondTheBitmapAreLive) {
+  Tombstones tombstones(10);
+
+  EXPECT_FALSE(tombstones.erase(10));
+  EXPECT_FALSE(tombstones.contains(1000));
+  EXPECT_EQ(tombstones.count(), 0u);
+}
+
+TEST(TombstonesTest, ResizeKeepsRemainingMarks) {
+  Tombstones tombstones(200);
+  tombstones.erase(5);
+  tombstones.erase(150);
+
+  tombstones.resize(1000);
+  EXPECT_TRUE(tombstones.contains(5));
+  EXPECT_TRUE(tombstones.contains(150));
+  EXPECT_TRUE(tombstones.erase(999));
+  EXPECT_EQ(tombstones.count(), 3u);
+
+  tombstones.resize(100);
+  EXPECT_TRUE(tombstones.contains(5));
+  EXPECT_FALSE(tombstones.contains(150));
+  EXPECT_EQ(tombstones.count(), 1u);
+}
@@ -0,0 +1,66 @@
+#include "data-structures/top_k.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+TEST(TopKTest, SelectsBestInDescendingOrder) {
+  TopK top(3);
+  for (auto [score, doc_id] : std::vector<std::pair<double, uint32_t>>{
+           {0.5, 1}, {2.0, 2}, {1.0, 3}, {3.0, 4}, {0.1, 5}, {1.5, 6}}) {
+    top.push(score, doc_id);
+  }
+
+  EXPECT_DOUBLE_EQ(top.threshold(), 1.5);
+  EXPECT_EQ(top.extract(),
+            (std::vector<std::pair<uint32_t, double>>{{4, 3.0}, {2, 2.0}, {6, 1.5}}));
+  EXPECT_EQ(top.size(), 0u);
+}
+
+TEST(TopKTest, MatchesSorting) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> scores(0, 1000);
+  for (uint32_t k : {1u, 10u, 1000u}) {
+    std::vector<std::pair<double, uint32_t>> candidates;
+    TopK top(k);
+    for (uint32_t doc_id = 0; doc_id < 5000; ++doc_id) {
+      // Distinct scores, so the selection is unique
+      double score = scores(rng) + doc_id * 1e-6;
+      candidates.emplace_back(score, doc_id);
+      top.push(score, doc_id);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), std::greater<>());
+    auto results = top.extract();
+    ASSERT_EQ(results.size(), k);
+    for (uint32_t i = 0; i < k; ++i) {
+      EXPECT_EQ(results[i].first, candidates[i].second);
+    }
+  }
+}
+
+TEST(TopKTest, KeepsFirstOfTiedCandidates) {
+  TopK top(2);
+  top.push(1.0, 7);
+  top.push(1.0, 3);
+  top.push(1.0, 9);
+
+  EXPECT_EQ(top.extract(), (std::vector<std::pair<uint32_t, double>>{{7, 1.0}, {3, 1.0}}));
+}
+
+TEST(TopKTest, MergeAndEmptySelections) {
+  TopK none(0);
+  none.push(1.0, 1);
+  EXPECT_TRUE(none.extract().empty());
+
+  TopK left(2);
+  TopK right(2);
+  left.push(1.0, 1);
+  left.push(4.0, 2);
+  right.push(3.0, 3);
+  right.push(2.0, 4);
+  left.merge(right);
+  EXPECT_EQ(left.extract(), (std::vector<std::pair<uint32_t, double>>{{2, 4.0}, {3, 3.0}}));
+}
@@ -0,0 +1,534 @@
+#include "algorithms/inverted/inverted_index_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parquet_documents.hpp"
+#include "scoring/bm25.hpp"
+
+namespace {
+
+constexpr uint32_t kNumDocuments = 20000;
+
+/// Get a distinct made-up word for every n < 676.
+std::string word(uint32_t n) {
+  return {'t', static_cast<char>('a' + n / 26), static_cast<char>('a' + n % 26)};
+}
+
+/// The corpus, in a shuffled id order, so the runs of every thread overlap.
+std::vector<std::pair<DocumentID, std::string>> makeDocuments() {
+  std::vector<std::pair<DocumentID, std::string>> documents;
+  for (uint32_t i = 0; i < kNumDocuments; ++i) {
+    std::string content;
+    for (uint32_t j = 0; j <= i % 3; ++j) content += "common ";
+    if (i % 4 != 0) content += "frequent ";
+    content += word(i % 50) + " " + word(50 + i % 13) + " " + word(70 + i % 7);
+    documents.emplace_back(i * 7919 % kNumDocuments, content);
+  }
+  return documents;
+}
+
+/// Writes the corpus to directory.
+void writeDocuments(const test::TemporaryDirectory &directory) {
+  test::writeDocuments(directory.path() / "documents.parquet", makeDocuments());
+}
+
+/// The scores of the results of every query, which don't depend on how ties are broken.
+using Scores = std::vector<std::vector<double>>;
+
+/// Answers the queries exhaustively and with MaxScore.
+std::pair<Scores, Scores> answer(InvertedIndexEngine& engine,
+                                 const std::vector<std::string>& queries) {
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  auto score_all = [&]() {
+    Scores scores;
+    for (const auto& query : queries) {
+      auto& query_scores = scores.emplace_back();
+      for (const auto& [doc_id, score] : engine.search(query, bm25, 10)) {
+        query_scores.push_back(score);
+      }
+    }
+    return scores;
+  };
+  Scores exhaustive = score_all();
+  engine.computeMaxScores(bm25);
+  return {exhaustive, score_all()};
+}
+
+/// A corpus without ties of posting scores: documents 0 to 19 contain word(k) for 1 <= k <= 4
+/// if k + 1 divides their id + 1, so every word has another document frequency. word(10),
+/// repeated id + 1 times to give every document another length, and word(11) are in all.
+std::vector<std::pair<DocumentID, std::string>> makePruningDocuments() {
+  std::vector<std::pair<DocumentID, std::string>> documents;
+  for (DocumentID doc_id = 0; doc_id < 20; ++doc_id) {
+    std::string content = word(11);
+    for (uint32_t k = 1; k <= 4; ++k) {
+      if ((doc_id + 1) % (k + 1) == 0) content += " " + word(k);
+    }
+    for (uint32_t i = 0; i <= doc_id; ++i) content += " " + word(10);
+    documents.emplace_back(doc_id, content);
+  }
+  return documents;
+}
+
+/// The postings of every word of the pruning corpus, by document id.
+using WordScores = std::vector<std::unordered_map<DocumentID, double>>;
+
+/// Get the score of every posting of the words 1 to 4 of the pruning corpus.
+WordScores scoreWords(InvertedIndexEngine &engine, const scoring::ScoringFunction &score_func) {
+  WordScores word_scores(5);
+  for (uint32_t k = 1; k <= 4; ++k) {
+    for (const auto &[doc_id, score] : engine.search(word(k), score_func, 100)) {
+      word_scores[k][doc_id] = score;
+    }
+  }
+  return word_scores;
+}
+
+}  // namespace
+
+TEST(InvertedIndexEngineTest, SpilledBuildRanksLikeInMemoryBuild) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  writeDocuments(directory);
+  std::string data_path = directory.path().string();
+
+  // Two query threads split the postings of the frequent tokens into ranges by document id
+  InvertedIndexEngine in_memory(false, false, 2);
+  in_memory.indexDocuments(data_path);
+  InvertedIndexEngine spilled(false, false, 2);
+  spilled.setMemoryBudget(1, data_path);
+  spilled.indexDocuments(data_path);
+  EXPECT_GT(spilled.getSpillStatistics().runs, 1u);
+
+  std::vector<std::string> queries = {"common frequent", "common frequent " + word(3),
+                                      word(7) + " " + word(55) + " " + word(72), "frequent"};
+  auto [exhaustive, max_score] = answer(in_memory, queries);
+  auto [spilled_exhaustive, spilled_max_score] = answer(spilled, queries);
+  EXPECT_EQ(spilled_exhaustive, exhaustive);
+  EXPECT_EQ(spilled_max_score, max_score);
+  EXPECT_EQ(max_score, exhaustive);
+}
+
+TEST(InvertedIndexEngineTest, CachedScoresFollowTheCorpus) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  // Enough documents with common for its scores to be cached
+  std::vector<std::pair<DocumentID, std::string>> documents;
+  for (DocumentID doc_id = 1; doc_id <= 1000; ++doc_id) {
+    documents.emplace_back(doc_id, "common " + word(doc_id % 20) + (doc_id <= 200 ? " long" : ""));
+  }
+  test::writeDocuments(directory.path() / "documents.parquet", documents);
+  std::string data_path = directory.path().string();
+
+  InvertedIndexEngine cached(false, false, 1, 1 << 20);
+  cached.indexDocuments(data_path);
+  InvertedIndexEngine uncached(false, false);
+  uncached.indexDocuments(data_path);
+  scoring::BM25 bm25(cached.getDocumentCount(), cached.getAvgDocumentLength());
+  EXPECT_EQ(cached.search("common", bm25, 10), uncached.search("common", bm25, 10));
+  EXPECT_EQ(cached.getScoreCache()->getAdmissions(), 1u);
+
+  // A scoring function of the same name with the new statistics must not get the old scores
+  for (DocumentID doc_id = 1; doc_id <= 200; ++doc_id) {
+    ASSERT_TRUE(cached.deleteDocument(doc_id));
+    ASSERT_TRUE(uncached.deleteDocument(doc_id));
+  }
+  scoring::BM25 new_bm25(cached.getDocumentCount(), cached.getAvgDocumentLength());
+  ASSERT_EQ(new_bm25.getName(), bm25.getName());
+  EXPECT_EQ(cached.search("common", new_bm25, 10), uncached.search("common", new_bm25, 10));
+  EXPECT_EQ(cached.getScoreCache()->getAdmissions(), 2u);
+}
+
+TEST(InvertedIndexEngineTest, NarrowScoresRankLikeDouble) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  writeDocuments(directory);
+  std::string data_path = directory.path().string();
+
+  // Two query threads score the queries with common and frequent in ranges
+  InvertedIndexEngine exact(false, false, 2);
+  exact.indexDocuments(data_path);
+  InvertedIndexEngine single(false, false, 2, 0, InvertedIndexEngine::Precision::Float);
+  single.indexDocuments(data_path);
+  InvertedIndexEngine quantized(false, false, 2, 0, InvertedIndexEngine::Precision::Quantized);
+  quantized.indexDocuments(data_path);
+  scoring::BM25 bm25(exact.getDocumentCount(), exact.getAvgDocumentLength());
+  quantized.quantizeImpacts(bm25);
+
+  std::vector<std::string> queries = {"common frequent", "common frequent " + word(3),
+                                      word(7) + " " + word(55) + " " + word(72), "frequent"};
+  for (const auto &query : queries) {
+    auto expected = exact.search(query, bm25, 10);
+    auto float_results = single.search(query, bm25, 10);
+    auto quantized_results = quantized.search(query, bm25, 10);
+    ASSERT_EQ(float_results.size(), expected.size());
+    ASSERT_EQ(quantized_results.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR(float_results[i].second, expected[i].second, 1e-4 * expected[i].second);
+      // Every posting's impact is off by at most half the score of impact 1
+      EXPECT_NEAR(quantized_results[i].second, expected[i].second, 0.1);
+    }
+  }
+}
+
+TEST(InvertedIndexEngineTest, ImpactOrderedRanksLikeQuantized) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  writeDocuments(directory);
+  std::string data_path = directory.path().string();
+
+  InvertedIndexEngine quantized(false, false, 1, 0, InvertedIndexEngine::Precision::Quantized);
+  quantized.indexDocuments(data_path);
+  InvertedIndexEngine impact_ordered(false, false);
+  impact_ordered.indexDocuments(data_path);
+  scoring::BM25 bm25(quantized.getDocumentCount(), quantized.getAvgDocumentLength());
+  quantized.quantizeImpacts(bm25);
+  impact_ordered.orderByImpact(bm25);
+
+  // Ties may be broken differently, so all matches are compared by document id
+  auto by_doc_id = [](std::vector<std::pair<DocumentID, double>> results) {
+    std::sort(results.begin(), results.end());
+    return results;
+  };
+  std::vector<std::string> queries = {"common frequent", "common frequent " + word(3),
+                                      word(7) + " " + word(55) + " " + word(72), "frequent"};
+  for (const auto &query : queries) {
+    auto expected = quantized.search(query, bm25, kNumDocuments);
+    auto actual = impact_ordered.search(query, bm25, kNumDocuments);
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ(by_doc_id(actual), by_doc_id(expected));
+  }
+}
+
+TEST(InvertedIndexEngineTest, PostingBudgetKeepsHighestImpacts) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  writeDocuments(directory);
+  std::string data_path = directory.path().string();
+
+  InvertedIndexEngine quantized(false, false, 1, 0, InvertedIndexEngine::Precision::Quantized);
+  quantized.indexDocuments(data_path);
+  InvertedIndexEngine budgeted(false, false);
+  budgeted.indexDocuments(data_path);
+  scoring::BM25 bm25(quantized.getDocumentCount(), quantized.getAvgDocumentLength());
+  quantized.quantizeImpacts(bm25);
+  constexpr uint32_t kBudget = 1000;
+  budgeted.orderByImpact(bm25, kBudget);
+
+  // A single token's postings are processed by descending impact, so the budget yields its
+  // best scoring documents
+  auto expected = quantized.search("frequent", bm25, kNumDocuments);
+  auto actual = budgeted.search("frequent", bm25, kNumDocuments);
+  ASSERT_GT(expected.size(), kBudget);
+  ASSERT_EQ(actual.size(), kBudget);
+  for (size_t i = 0; i < kBudget; ++i) {
+    EXPECT_EQ(actual[i].second, expected[i].second);
+  }
+
+  // Of several tokens, the documents get at most their full score from the processed postings
+  std::unordered_map<DocumentID, double> full_scores;
+  for (const auto &[doc_id, score] : quantized.search("common frequent", bm25, kNumDocuments)) {
+    full_scores[doc_id] = score;
+  }
+  auto partial = budgeted.search("common frequent", bm25, kNumDocuments);
+  EXPECT_LE(partial.size(), kBudget);
+  ASSERT_FALSE(partial.empty());
+  for (const auto &[doc_id, score] : partial) {
+    ASSERT_TRUE(full_scores.contains(doc_id));
+    EXPECT_LE(score, full_scores[doc_id]);
+  }
+  // The best document of the budgeted query is among the best of the full one
+  EXPECT_EQ(partial[0].second, quantized.search("common frequent", bm25, 1)[0].second);
+}
+
+TEST(InvertedIndexEngineTest, ZeroScoresAreOfferedOnce) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  // common is in almost every document, so its impacts round to 0
+  std::vector<std::pair<DocumentID, std::string>> documents = {{0, "rare"}};
+  for (DocumentID doc_id = 1; doc_id < 2000; ++doc_id) {
+    documents.emplace_back(doc_id, "common " + word(doc_id % 20));
+  }
+  documents.emplace_back(2000, "common zebra");
+  test::writeDocuments(directory.path() / "documents.parquet", documents);
+  std::string data_path = directory.path().string();
+
+  InvertedIndexEngine single(false, false, 1, 0, InvertedIndexEngine::Precision::Float);
+  single.indexDocuments(data_path);
+  InvertedIndexEngine quantized(false, false, 1, 0, InvertedIndexEngine::Precision::Quantized);
+  quantized.indexDocuments(data_path);
+  scoring::BM25 bm25(single.getDocumentCount(), single.getAvgDocumentLength());
+  quantized.quantizeImpacts(bm25);
+
+  // More results are asked for than documents match, so every touched document is returned
+  auto is_unique = [](std::vector<DocumentID> doc_ids) {
+    std::sort(doc_ids.begin(), doc_ids.end());
+    return std::adjacent_find(doc_ids.begin(), doc_ids.end()) == doc_ids.end();
+  };
+  auto float_results = single.search("common zebra", bm25, 5000);
+  EXPECT_EQ(float_results.size(), 2000u);
+  EXPECT_TRUE(is_unique(test::ids(float_results)));
+  EXPECT_EQ(float_results[0].first, 2000u);
+  // Only zebra adds to a quantized score
+  auto quantized_results = quantized.search("common zebra", bm25, 5000);
+  EXPECT_EQ(test::ids(quantized_results), (std::vector<DocumentID>{2000}));
+}
+
+TEST(InvertedIndexEngineTest, DeleteUpdateAndCompact) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  // 0 and 5 are gaps of the document ids
+  test::writeDocuments(directory.path() / "documents.parquet", {{1, "zebra walrus"},
+                                                                {2, "zebra"},
+                                                                {3, "walrus walrus yak"},
+                                                                {4, "narwhal"},
+                                                                {6, "zebra narwhal"}});
+  std::string data_path = directory.path().string();
+  InvertedIndexEngine engine(false, false);
+  engine.indexDocuments(data_path);
+  uint32_t num_documents = engine.getDocumentCount();
+  EXPECT_DOUBLE_EQ(engine.getAvgDocumentLength(), 9.0 / num_documents);
+
+  EXPECT_FALSE(engine.deleteDocument(0));
+  EXPECT_FALSE(engine.deleteDocument(5));
+  EXPECT_FALSE(engine.deleteDocument(1000));
+  EXPECT_EQ(engine.getDocumentCount(), num_documents);
+
+  uint64_t version = engine.getIndexVersion();
+  ASSERT_TRUE(engine.deleteDocument(2));
+  EXPECT_FALSE(engine.deleteDocument(2));
+  EXPECT_GT(engine.getIndexVersion(), version);
+  EXPECT_EQ(engine.getDocumentCount(), num_documents - 1);
+  EXPECT_DOUBLE_EQ(engine.getAvgDocumentLength(), 8.0 / (num_documents - 1));
+  auto sorted_ids = [&](const std::string &query) {
+    scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+    auto doc_ids = test::ids(engine.search(query, bm25, 10));
+    std::sort(doc_ids.begin(), doc_ids.end());
+    return doc_ids;
+  };
+  EXPECT_EQ(sorted_ids("zebra"), (std::vector<DocumentID>{1, 6}));
+
+  // The postings of document 2 are removed, it stays deleted
+  uint64_t footprint = engine.footprint_size();
+  engine.compact();
+  EXPECT_LT(engine.footprint_size(), footprint);
+  EXPECT_EQ(sorted_ids("zebra"), (std::vector<DocumentID>{1, 6}));
+  EXPECT_EQ(engine.getDocumentCount(), num_documents - 1);
+  EXPECT_FALSE(engine.deleteDocument(2));
+
+  // Document 1 is replaced, 7 is added
+  auto update = directory.path() / "update" / "documents.parquet";
+  std::filesystem::create_directories(update.parent_path());
+  test::writeDocuments(update, {{1, "yak"}, {7, "zebra"}});
+  engine.updateDocuments(update.string());
+  EXPECT_EQ(sorted_ids("zebra"), (std::vector<DocumentID>{6, 7}));
+  EXPECT_EQ(sorted_ids("yak"), (std::vector<DocumentID>{1, 3}));
+  EXPECT_EQ(sorted_ids("walrus"), (std::vector<DocumentID>{3}));
+  EXPECT_EQ(engine.getDocumentCount(), num_documents);
+  EXPECT_DOUBLE_EQ(engine.getAvgDocumentLength(), 8.0 / num_documents);
+}
+
+TEST(InvertedIndexEngineTest, DeletionsInvalidateImpactsAndMaxScores) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  writeDocuments(directory);
+  std::string data_path = directory.path().string();
+
+  InvertedIndexEngine exact(false, false);
+  exact.indexDocuments(data_path);
+  InvertedIndexEngine max_score(false, false);
+  max_score.indexDocuments(data_path);
+  InvertedIndexEngine quantized(false, false, 1, 0, InvertedIndexEngine::Precision::Quantized);
+  quantized.indexDocuments(data_path);
+  InvertedIndexEngine impact_ordered(false, false);
+  impact_ordered.indexDocuments(data_path);
+  scoring::BM25 bm25(exact.getDocumentCount(), exact.getAvgDocumentLength());
+  max_score.computeMaxScores(bm25);
+  quantized.quantizeImpacts(bm25);
+  impact_ordered.orderByImpact(bm25);
+
+  // The documents with one common are short, deleting them changes the statistics a lot
+  for (DocumentID doc_id = 0; doc_id < kNumDocuments; ++doc_id) {
+    if (doc_id * 7919 % kNumDocuments % 3 == 0) {
+      for (auto *engine : {&exact, &max_score, &quantized, &impact_ordered}) {
+        ASSERT_TRUE(engine->deleteDocument(doc_id * 7919 % kNumDocuments));
+      }
+    }
+  }
+  scoring::BM25 new_bm25(exact.getDocumentCount(), exact.getAvgDocumentLength());
+  std::vector<std::string> queries = {"common frequent", word(7) + " " + word(55), "frequent"};
+  for (const auto &query : queries) {
+    auto expected = exact.search(query, new_bm25, 10);
+    // The precomputed data is stale, so all of them score exactly
+    EXPECT_EQ(max_score.search(query, new_bm25, 10), expected);
+    EXPECT_EQ(quantized.search(query, new_bm25, 10), expected);
+    EXPECT_EQ(impact_ordered.search(query, new_bm25, 10), expected);
+  }
+}
+
+TEST(InvertedIndexEngineTest, TermCentricPruning) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  test::writeDocuments(directory.path() / "documents.parquet", makePruningDocuments());
+  std::string data_path = directory.path().string();
+  InvertedIndexEngine engine(false, false);
+  engine.indexDocuments(data_path);
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  std::vector<std::vector<std::pair<DocumentID, double>>> unpruned(5);
+  for (uint32_t k = 1; k <= 4; ++k) {
+    unpruned[k] = engine.search(word(k), bm25, 100);
+  }
+
+  // The words in all documents exceed the maximum document frequency of 18
+  engine.prune(bm25, InvertedIndexEngine::Pruning::TermCentric, 0.3, 0.9);
+  EXPECT_TRUE(engine.search(word(10), bm25, 100).empty());
+  EXPECT_TRUE(engine.search(word(11), bm25, 100).empty());
+  // The best scoring 30% of the postings of every word are left, scored as before
+  uint64_t num_kept = 0;
+  for (uint32_t k = 1; k <= 4; ++k) {
+    size_t num_postings = unpruned[k].size();
+    ASSERT_EQ(num_postings, 20 / (k + 1));
+    auto kept = static_cast<size_t>(std::ceil(0.3 * static_cast<double>(num_postings)));
+    std::vector<std::pair<DocumentID, double>> expected(unpruned[k].begin(),
+                                                        unpruned[k].begin() + kept);
+    EXPECT_EQ(engine.search(word(k), bm25, 100), expected);
+    num_kept += kept;
+  }
+
+  const auto &statistics = engine.getPruningStatistics();
+  EXPECT_EQ(statistics.removed_terms, 2u);
+  EXPECT_EQ(statistics.remaining_postings, num_kept);
+  // 20 postings of both frequent words and the pruned ones of 10, 6, 5 and 4
+  EXPECT_EQ(statistics.removed_postings, 40 + 25 - num_kept);
+}
+
+TEST(InvertedIndexEngineTest, DocumentCentricPruning) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  test::writeDocuments(directory.path() / "documents.parquet", makePruningDocuments());
+  std::string data_path = directory.path().string();
+  InvertedIndexEngine engine(false, false);
+  engine.indexDocuments(data_path);
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  WordScores unpruned = scoreWords(engine, bm25);
+
+  engine.prune(bm25, InvertedIndexEngine::Pruning::DocumentCentric, 0.5, 0.9);
+  WordScores pruned = scoreWords(engine, bm25);
+  EXPECT_TRUE(engine.search(word(10), bm25, 100).empty());
+  EXPECT_TRUE(engine.search(word(11), bm25, 100).empty());
+
+  // Every document keeps the best scoring half of its words, at least one, scored as before
+  uint64_t num_postings = 0;
+  uint64_t num_kept = 0;
+  for (DocumentID doc_id = 0; doc_id < 20; ++doc_id) {
+    std::vector<std::pair<double, uint32_t>> words;
+    for (uint32_t k = 1; k <= 4; ++k) {
+      if (unpruned[k].contains(doc_id)) words.emplace_back(unpruned[k][doc_id], k);
+    }
+    std::sort(words.begin(), words.end(), std::greater<>());
+    size_t kept = (words.size() + 1) / 2;
+    for (size_t i = 0; i < words.size(); ++i) {
+      auto [score, k] = words[i];
+      ASSERT_EQ(pruned[k].contains(doc_id), i < kept) << "document " << doc_id << ", word " << k;
+      if (i < kept) {
+        EXPECT_EQ(pruned[k][doc_id], score);
+      }
+    }
+    num_postings += words.size();
+    num_kept += kept;
+  }
+
+  const auto &statistics = engine.getPruningStatistics();
+  EXPECT_EQ(statistics.removed_terms, 2u);
+  EXPECT_EQ(statistics.remaining_postings, num_kept);
+  EXPECT_EQ(statistics.removed_postings, 40 + num_postings - num_kept);
+}
+
+TEST(InvertedIndexEngineTest, PruningRejectsInvalidShares) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  test::writeDocuments(directory.path() / "documents.parquet", makePruningDocuments());
+  std::string data_path = directory.path().string();
+  InvertedIndexEngine engine(false, false);
+  engine.indexDocuments(data_path);
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  auto unpruned = engine.search(word(11), bm25, 100);
+
+  using Pruning = InvertedIndexEngine::Pruning;
+  for (double keep_share : {-0.5, 0.0, 1.5, std::nan("")}) {
+    EXPECT_THROW(engine.prune(bm25, Pruning::TermCentric, keep_share), std::invalid_argument);
+  }
+  for (double max_df_share : {-0.1, 1.1, std::nan("")}) {
+    EXPECT_THROW(engine.prune(bm25, Pruning::None, 0.5, max_df_share), std::invalid_argument);
+  }
+  EXPECT_EQ(engine.search(word(11), bm25, 100), unpruned);
+
+  // Keeping everything removes nothing
+  engine.prune(bm25, Pruning::DocumentCentric, 1.0, 1.0);
+  EXPECT_EQ(engine.getPruningStatistics().removed_postings, 0u);
+  EXPECT_EQ(engine.search(word(11), bm25, 100), unpruned);
+}
+
+TEST(InvertedIndexEngineTest, ReorderedDocumentsRankLikeOriginalOrder) {
+  test::TemporaryDirectory directory("inverted_index_engine_test");
+  writeDocuments(directory);
+  std::string data_path = directory.path().string();
+
+  // Double on two query threads, quantized, impact-ordered and MaxScore, once in the
+  // original order and once renumbered
+  using Precision = InvertedIndexEngine::Precision;
+  std::vector<std::unique_ptr<InvertedIndexEngine>> engines;
+  for (bool reorder : {false, true}) {
+    engines.push_back(std::make_unique<InvertedIndexEngine>(false, false, 2, 0, Precision::Double,
+                                                            reorder));
+    engines.push_back(std::make_unique<InvertedIndexEngine>(false, false, 1, 0,
+                                                            Precision::Quantized, reorder));
+    engines.push_back(std::make_unique<InvertedIndexEngine>(false, false, 1, 0, Precision::Double,
+                                                            reorder));
+    engines.push_back(std::make_unique<InvertedIndexEngine>(false, false, 1, 0, Precision::Double,
+                                                            reorder));
+  }
+  for (auto &engine : engines) {
+    engine->indexDocuments(data_path);
+  }
+  scoring::BM25 bm25(engines[0]->getDocumentCount(), engines[0]->getAvgDocumentLength());
+  for (size_t offset : {0, 4}) {
+    engines[offset + 1]->quantizeImpacts(bm25);
+    engines[offset + 2]->orderByImpact(bm25);
+    engines[offset + 3]->computeMaxScores(bm25);
+  }
+  // Similar documents get close ids
+  EXPECT_LT(engines[4]->getAverageGapBits(), engines[0]->getAverageGapBits());
+
+  auto by_doc_id = [](std::vector<std::pair<DocumentID, double>> results) {
+    std::sort(results.begin(), results.end());
+    return results;
+  };
+  auto expect_same_results = [&](const scoring::ScoringFunction &score_func, size_t num_engines) {
+    std::vector<std::string> queries = {"common frequent", "common frequent " + word(3),
+                                        word(7) + " " + word(55) + " " + word(72), "frequent"};
+    for (const auto &query : queries) {
+      for (size_t i = 0; i < num_engines; ++i) {
+        auto expected = engines[i]->search(query, score_func, kNumDocuments);
+        auto actual = engines[i + 4]->search(query, score_func, kNumDocuments);
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(by_doc_id(actual), by_doc_id(expected)) << query << ", engine " << i;
+      }
+    }
+  };
+  expect_same_results(bm25, 4);
+
+  // Documents are deleted by their original id
+  for (DocumentID doc_id : {0u, 7919u, 12345u}) {
+    for (size_t i : {0, 4}) {
+      ASSERT_TRUE(engines[i]->deleteDocument(doc_id));
+      EXPECT_FALSE(engines[i]->deleteDocument(doc_id));
+    }
+  }
+  EXPECT_FALSE(engines[4]->deleteDocument(kNumDocuments));
+  scoring::BM25 new_bm25(engines[0]->getDocumentCount(), engines[0]->getAvgDocumentLength());
+  expect_same_results(new_bm25, 1);
+  for (const auto &[doc_id, score] : engines[4]->search("common", new_bm25, kNumDocuments)) {
+    EXPECT_TRUE(doc_id != 0 && doc_id != 7919 && doc_id != 12345);
+  }
+}
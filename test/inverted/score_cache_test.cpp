@@ -0,0 +1,73 @@
+#include "algorithms/inverted/score_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+std::shared_ptr<const ScoreCache::Scores> makeScores(size_t size, double value) {
+  return std::make_shared<const ScoreCache::Scores>(size, value);
+}
+
+}  // namespace
+
+TEST(ScoreCacheTest, HitsAndMisses) {
+  ScoreCache cache(1 << 20);
+
+  EXPECT_EQ(cache.lookup("fox"), nullptr);
+  ASSERT_TRUE(cache.admits("fox", 4));
+  cache.insert("fox", makeScores(4, 1.5));
+  auto scores = cache.lookup("fox");
+
+  ASSERT_NE(scores, nullptr);
+  EXPECT_EQ(*scores, (ScoreCache::Scores(4, 1.5)));
+  EXPECT_EQ(cache.getHits(), 1u);
+  EXPECT_EQ(cache.getMisses(), 1u);
+  EXPECT_EQ(cache.getAdmissions(), 1u);
+}
+
+TEST(ScoreCacheTest, RareKeysDontEvictHotOnes) {
+  ScoreCache probe(1 << 20);
+  probe.insert("hot", makeScores(100, 1.0));
+  ScoreCache cache(probe.getSizeBytes() + 100);
+
+  for (int i = 0; i < 5; ++i) cache.lookup("hot");
+  cache.insert("hot", makeScores(100, 1.0));
+
+  // A key queried once is less frequent than the only possible victim
+  cache.lookup("cold");
+  EXPECT_FALSE(cache.admits("cold", 100));
+  cache.insert("cold", makeScores(100, 2.0));
+  EXPECT_NE(cache.lookup("hot"), nullptr);
+  EXPECT_EQ(cache.lookup("cold"), nullptr);
+  EXPECT_EQ(cache.getEvictions(), 0u);
+
+  // Once it is queried more often than the victim, it replaces it
+  for (int i = 0; i < 10; ++i) cache.lookup("cold");
+  ASSERT_TRUE(cache.admits("cold", 100));
+  cache.insert("cold", makeScores(100, 2.0));
+  EXPECT_EQ(cache.lookup("hot"), nullptr);
+  EXPECT_NE(cache.lookup("cold"), nullptr);
+  EXPECT_EQ(cache.getEvictions(), 1u);
+}
+
+TEST(ScoreCacheTest, EvictedScoresStayValid) {
+  ScoreCache cache(1 << 20);
+  cache.insert("fox", makeScores(8, 3.0));
+  auto scores = cache.lookup("fox");
+  cache.clear();
+
+  EXPECT_EQ(cache.lookup("fox"), nullptr);
+  EXPECT_EQ(cache.getSizeBytes(), 0u);
+  EXPECT_EQ(*scores, (ScoreCache::Scores(8, 3.0)));
+}
+
+TEST(ScoreCacheTest, RejectsEntriesLargerThanCapacity) {
+  ScoreCache cache(256);
+
+  EXPECT_FALSE(cache.admits("fox", 1000));
+  cache.insert("fox", makeScores(1000, 1.0));
+  EXPECT_EQ(cache.lookup("fox"), nullptr);
+}
@@ -0,0 +1,171 @@
+#include "algorithms/inverted/segmented_index_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "algorithms/inverted/inverted_index_engine.hpp"
+#include "parquet_documents.hpp"
+#include "scoring/bm25.hpp"
+
+namespace {
+
+/// Get a distinct made-up word for every n < 676.
+std::string word(uint32_t n) {
+  return {'s', static_cast<char>('a' + n / 26), static_cast<char>('a' + n % 26)};
+}
+
+/// The documents with ids in [first_doc, last_doc).
+std::vector<std::pair<DocumentID, std::string>> makeDocuments(DocumentID first_doc,
+                                                              DocumentID last_doc) {
+  std::vector<std::pair<DocumentID, std::string>> documents;
+  for (DocumentID doc_id = first_doc; doc_id < last_doc; ++doc_id) {
+    std::string content = "common " + word(doc_id % 40) + " " + word(40 + doc_id % 7);
+    if (doc_id % 3 == 0) content += " frequent frequent";
+    documents.emplace_back(doc_id, content);
+  }
+  return documents;
+}
+
+/// Writes the documents with ids in [first_doc, last_doc) to a file of its own.
+std::string writeFile(const test::TemporaryDirectory &directory, DocumentID first_doc,
+                      DocumentID last_doc) {
+  auto file = directory.path() / ("documents_" + std::to_string(first_doc) + ".parquet");
+  test::writeDocuments(file, makeDocuments(first_doc, last_doc));
+  return file.string();
+}
+
+/// The scores of the results, which don't depend on how ties are broken.
+std::vector<double> scores(const std::vector<std::pair<DocumentID, double>> &results) {
+  std::vector<double> result_scores;
+  for (const auto &[doc_id, score] : results) result_scores.push_back(score);
+  return result_scores;
+}
+
+/// Whether a document is among all results of the query.
+bool found(SegmentedIndexEngine &engine, const std::string &query, DocumentID doc_id) {
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  for (const auto &[result_id, score] : engine.search(query, bm25, 100000)) {
+    if (result_id == doc_id) return true;
+  }
+  return false;
+}
+
+const std::vector<std::string> kQueries = {"common", "frequent " + word(3),
+                                           word(11) + " " + word(42), "common frequent"};
+
+}  // namespace
+
+TEST(SegmentedIndexEngineTest, RanksLikeInvertedIndex) {
+  test::TemporaryDirectory directory("segmented_index_engine_test");
+  // No tier is full, so the segments stay apart
+  SegmentedIndexEngine segmented(false, false, 8);
+  segmented.addDocuments(writeFile(directory, 0, 300));
+  segmented.addDocuments(writeFile(directory, 300, 350));
+  segmented.addDocuments(writeFile(directory, 350, 1000));
+  InvertedIndexEngine inverted(false, false);
+  std::string data_path = directory.path().string();
+  inverted.indexDocuments(data_path);
+
+  EXPECT_EQ(segmented.getSegmentCount(), 3u);
+  ASSERT_EQ(segmented.getDocumentCount(), inverted.getDocumentCount());
+  ASSERT_DOUBLE_EQ(segmented.getAvgDocumentLength(), inverted.getAvgDocumentLength());
+  scoring::BM25 bm25(inverted.getDocumentCount(), inverted.getAvgDocumentLength());
+  for (const auto &query : kQueries) {
+    auto expected = scores(inverted.search(query, bm25, 20));
+    auto actual = scores(segmented.search(query, bm25, 20));
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR(actual[i], expected[i], 1e-9);
+    }
+  }
+}
+
+TEST(SegmentedIndexEngineTest, MergesReduceSegmentCount) {
+  test::TemporaryDirectory directory("segmented_index_engine_test");
+  SegmentedIndexEngine engine(false, false, 2);
+  for (DocumentID first_doc = 0; first_doc < 400; first_doc += 100) {
+    engine.addDocuments(writeFile(directory, first_doc, first_doc + 100));
+  }
+  engine.waitForMerges();
+
+  // Two pairs of equal segments are merged, then the two results
+  EXPECT_EQ(engine.getSegmentCount(), 1u);
+  EXPECT_EQ(engine.getMergeCount(), 3u);
+  EXPECT_EQ(engine.getDocumentCount(), 400u);
+
+  SegmentedIndexEngine unmerged(false, false, 8);
+  for (DocumentID first_doc = 0; first_doc < 400; first_doc += 100) {
+    unmerged.addDocuments(writeFile(directory, first_doc, first_doc + 100));
+  }
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  for (const auto &query : kQueries) {
+    EXPECT_EQ(engine.search(query, bm25, 20), unmerged.search(query, bm25, 20));
+  }
+}
+
+TEST(SegmentedIndexEngineTest, DeletesAndUpdatesDuringMergesSurvive) {
+  test::TemporaryDirectory directory("segmented_index_engine_test");
+  std::string update = (directory.path() / "update.parquet").string();
+  test::writeDocuments(update, {{10, "updated walrus"}, {20000, "new walrus"}});
+
+  // Whether the merge has started when the documents change is up to the merge thread
+  for (int round = 0; round < 5; ++round) {
+    SegmentedIndexEngine engine(false, false, 2);
+    engine.addDocuments(writeFile(directory, 0, 5000));
+    engine.addDocuments(writeFile(directory, 5000, 10000));
+    EXPECT_TRUE(engine.deleteDocument(5));
+    EXPECT_TRUE(engine.deleteDocument(7000));
+    engine.updateDocuments(update);
+    engine.waitForMerges();
+
+    EXPECT_EQ(engine.getMergeCount(), 1u);
+    EXPECT_EQ(engine.getSegmentCount(), 2u);
+    EXPECT_EQ(engine.getDocumentCount(), 9999u);
+    EXPECT_FALSE(found(engine, "common", 5));
+    EXPECT_FALSE(found(engine, "common", 7000));
+    // Only the new version of document 10 is live
+    EXPECT_FALSE(found(engine, "common", 10));
+    EXPECT_TRUE(found(engine, "walrus", 10));
+    EXPECT_TRUE(found(engine, "walrus", 20000));
+    EXPECT_FALSE(engine.deleteDocument(5));
+  }
+}
+
+TEST(SegmentedIndexEngineTest, MergeDroppingDocumentsChangesVersion) {
+  test::TemporaryDirectory directory("segmented_index_engine_test");
+  SegmentedIndexEngine engine(false, false, 4);
+  engine.addDocuments(writeFile(directory, 0, 4));
+  ASSERT_TRUE(engine.deleteDocument(0));
+  ASSERT_TRUE(engine.deleteDocument(1));
+
+  // The third deletion leaves the segment mostly deleted, so it is rewritten
+  uint64_t version = engine.getIndexVersion();
+  ASSERT_TRUE(engine.deleteDocument(2));
+  engine.waitForMerges();
+  EXPECT_EQ(engine.getMergeCount(), 1u);
+  EXPECT_EQ(engine.getIndexVersion(), version + 2);
+  EXPECT_EQ(engine.getDocumentCount(), 1u);
+}
+
+TEST(SegmentedIndexEngineTest, AddingLiveDocumentsFails) {
+  test::TemporaryDirectory directory("segmented_index_engine_test");
+  SegmentedIndexEngine engine(false, false, 8);
+  engine.addDocuments(writeFile(directory, 0, 10));
+
+  std::string again = (directory.path() / "again.parquet").string();
+  test::writeDocuments(again, {{20, "walrus"}, {3, "walrus"}});
+  EXPECT_THROW(engine.addDocuments(again), std::invalid_argument);
+  EXPECT_EQ(engine.getSegmentCount(), 1u);
+  EXPECT_EQ(engine.getDocumentCount(), 10u);
+
+  // A deleted document may be added again
+  ASSERT_TRUE(engine.deleteDocument(3));
+  engine.addDocuments(again);
+  EXPECT_EQ(engine.getDocumentCount(), 11u);
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  EXPECT_EQ(test::ids(engine.search("walrus", bm25, 10)).size(), 2u);
+  EXPECT_FALSE(found(engine, "common", 3));
+}
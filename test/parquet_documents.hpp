@@ -0,0 +1,74 @@
+#ifndef TEST_PARQUET_DOCUMENTS_HPP
+#define TEST_PARQUET_DOCUMENTS_HPP
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <gtest/gtest.h>
+#include <parquet/arrow/writer.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fts_engine.hpp"
+
+namespace test {
+
+/// Writes documents as a Parquet file with the content and id columns of the corpus.
+inline void writeDocuments(const std::filesystem::path &file,
+                           const std::vector<std::pair<DocumentID, std::string>> &documents) {
+  arrow::BinaryBuilder contents;
+  arrow::UInt32Builder ids;
+  for (const auto &[doc_id, content] : documents) {
+    ASSERT_TRUE(contents.Append(content).ok());
+    ASSERT_TRUE(ids.Append(doc_id).ok());
+  }
+  std::shared_ptr<arrow::Array> content_array;
+  std::shared_ptr<arrow::Array> id_array;
+  ASSERT_TRUE(contents.Finish(&content_array).ok());
+  ASSERT_TRUE(ids.Finish(&id_array).ok());
+  auto schema = arrow::schema(
+      {arrow::field("content", arrow::binary()), arrow::field("id", arrow::uint32())});
+  auto table = arrow::Table::Make(schema, {content_array, id_array});
+
+  auto output = arrow::io::FileOutputStream::Open(file.string());
+  ASSERT_TRUE(output.ok());
+  ASSERT_TRUE(
+      parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), *output, 4096).ok());
+  ASSERT_TRUE((*output)->Close().ok());
+}
+
+/// A fresh directory below the temporary directory, removed with its files.
+class TemporaryDirectory {
+ public:
+  /// Constructor.
+  explicit TemporaryDirectory(const std::string &name)
+      : path_(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+  /// Destructor.
+  ~TemporaryDirectory() { std::filesystem::remove_all(path_); }
+
+  TemporaryDirectory(const TemporaryDirectory &) = delete;
+  TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+  /// Get the path of the directory.
+  [[nodiscard]] const std::filesystem::path &path() const { return path_; }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/// Get the document ids of results, best first.
+inline std::vector<DocumentID> ids(const std::vector<std::pair<DocumentID, double>> &results) {
+  std::vector<DocumentID> doc_ids;
+  for (const auto &[doc_id, score] : results) doc_ids.push_back(doc_id);
+  return doc_ids;
+}
+
+}  // namespace test
+
+#endif  // TEST_PARQUET_DOCUMENTS_HPP
@@ -0,0 +1,73 @@
+#include "queries/batch_executor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "scoring/tf_idf.hpp"
+
+namespace {
+
+/// Returns the query's length as its only document, so results reveal their query.
+class LengthEngine : public FullTextSearchEngine {
+ public:
+  void indexDocuments(std::string &) override {}
+  std::vector<std::pair<DocumentID, double>> search(const std::string &query,
+                                                    const scoring::ScoringFunction &,
+                                                    uint32_t num_results) override {
+    if (num_results == 0) return {};
+    return {{static_cast<DocumentID>(query.size()), 1.0}};
+  }
+  uint64_t footprint_size() override { return 0; }
+  uint64_t footprint_capacity() override { return 0; }
+  uint32_t getDocumentCount() override { return 0; }
+  double getAvgDocumentLength() override { return 0.0; }
+};
+
+}  // namespace
+
+TEST(BatchExecutorTest, KeepsQueryOrder) {
+  LengthEngine engine;
+  scoring::TfIdf tf_idf(1);
+  std::vector<queries::Query> batch;
+  for (size_t i = 0; i < 1000; ++i) {
+    batch.push_back({std::to_string(i), std::string(i % 97, 'x')});
+  }
+
+  queries::BatchExecutor executor(engine, tf_idf, 10, 4);
+  auto results = executor.run(batch);
+
+  ASSERT_EQ(results.size(), batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_EQ(results[i].documents.size(), 1u);
+    EXPECT_EQ(results[i].documents[0].first, i % 97);
+  }
+  EXPECT_EQ(executor.getStatistics().num_queries, batch.size());
+  EXPECT_EQ(executor.getStatistics().num_threads, 4u);
+}
+
+TEST(BatchExecutorTest, EmptyBatch) {
+  LengthEngine engine;
+  scoring::TfIdf tf_idf(1);
+  queries::BatchExecutor executor(engine, tf_idf, 10, 4);
+
+  EXPECT_TRUE(executor.run({}).empty());
+  EXPECT_EQ(executor.getStatistics().num_queries, 0u);
+  EXPECT_EQ(executor.getStatistics().queries_per_second, 0.0);
+}
+
+TEST(BatchExecutorTest, Percentiles) {
+  std::vector<uint64_t> latencies;
+  for (uint64_t i = 100; i >= 1; --i) {
+    latencies.push_back(i);
+  }
+
+  auto statistics = queries::BatchExecutor::summarize(latencies, 1'000'000'000, 2);
+  EXPECT_EQ(statistics.num_queries, 100u);
+  EXPECT_DOUBLE_EQ(statistics.queries_per_second, 100.0);
+  EXPECT_EQ(statistics.mean_latency_ns, 50u);
+  EXPECT_EQ(statistics.p50_latency_ns, 50u);
+  EXPECT_EQ(statistics.p95_latency_ns, 95u);
+  EXPECT_EQ(statistics.p99_latency_ns, 99u);
+  EXPECT_EQ(statistics.max_latency_ns, 100u);
+}
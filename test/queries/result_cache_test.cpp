@@ -0,0 +1,129 @@
+#include "queries/result_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <memory>
+#include <string>
+
+#include "queries/caching_engine.hpp"
+#include "scoring/bm25.hpp"
+#include "scoring/tf_idf.hpp"
+
+namespace {
+
+using Results = queries::QueryResultCache::Results;
+
+/// Counts its searches, its index version changes on every indexDocuments call.
+class CountingEngine : public FullTextSearchEngine {
+ public:
+  void indexDocuments(std::string &) override { markIndexChanged(); }
+  std::vector<std::pair<DocumentID, double>> search(const std::string &query,
+                                                    const scoring::ScoringFunction &,
+                                                    uint32_t) override {
+    ++searches;
+    return {{static_cast<DocumentID>(query.size()), 1.0}};
+  }
+  uint64_t footprint_size() override { return 0; }
+  uint64_t footprint_capacity() override { return 0; }
+  uint32_t getDocumentCount() override { return 0; }
+  double getAvgDocumentLength() override { return 0.0; }
+  /// Ignores the case of the query.
+  std::string normalizeQuery(const std::string &query) override {
+    std::string normalized = query;
+    for (auto &c : normalized) c = static_cast<char>(std::tolower(c));
+    return normalized;
+  }
+
+  uint32_t searches = 0;
+};
+
+}  // namespace
+
+TEST(QueryResultCacheTest, HitsAndMisses) {
+  queries::QueryResultCache cache(1 << 20);
+  Results results;
+
+  EXPECT_FALSE(cache.lookup("a", 0, results));
+  cache.insert("a", 0, {{1, 2.0}, {3, 1.0}});
+  ASSERT_TRUE(cache.lookup("a", 0, results));
+  EXPECT_EQ(results, (Results{{1, 2.0}, {3, 1.0}}));
+
+  EXPECT_EQ(cache.getHits(), 1u);
+  EXPECT_EQ(cache.getMisses(), 1u);
+  EXPECT_DOUBLE_EQ(cache.getHitRate(), 0.5);
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(QueryResultCacheTest, EvictsLeastRecentlyUsed) {
+  queries::QueryResultCache probe(1 << 20);
+  probe.insert("a", 0, {{1, 1.0}});
+  uint64_t entry_bytes = probe.getSizeBytes();
+
+  queries::QueryResultCache cache(3 * entry_bytes);
+  cache.insert("a", 0, {{1, 1.0}});
+  cache.insert("b", 0, {{2, 1.0}});
+  cache.insert("c", 0, {{3, 1.0}});
+  Results results;
+  ASSERT_TRUE(cache.lookup("a", 0, results));
+
+  // b is the least recently used entry now
+  cache.insert("d", 0, {{4, 1.0}});
+  EXPECT_EQ(cache.size(), 3u);
+  EXPECT_LE(cache.getSizeBytes(), 3 * entry_bytes);
+  EXPECT_FALSE(cache.lookup("b", 0, results));
+  EXPECT_TRUE(cache.lookup("a", 0, results));
+  EXPECT_TRUE(cache.lookup("c", 0, results));
+  EXPECT_TRUE(cache.lookup("d", 0, results));
+}
+
+TEST(QueryResultCacheTest, SkipsEntriesLargerThanCapacity) {
+  queries::QueryResultCache cache(64);
+  cache.insert("a", 0, Results(100, {1, 1.0}));
+
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_EQ(cache.getSizeBytes(), 0u);
+}
+
+TEST(QueryResultCacheTest, NewerVersionDropsEntries) {
+  queries::QueryResultCache cache(1 << 20);
+  Results results;
+  cache.insert("a", 1, {{1, 1.0}});
+
+  EXPECT_FALSE(cache.lookup("a", 2, results));
+  EXPECT_EQ(cache.size(), 0u);
+
+  // Results of an outdated version are not cached
+  cache.insert("a", 1, {{1, 1.0}});
+  EXPECT_FALSE(cache.lookup("a", 2, results));
+}
+
+TEST(CachingEngineTest, AnswersRepeatedQueries) {
+  auto counting = std::make_unique<CountingEngine>();
+  auto &engine = *counting;
+  queries::CachingEngine caching(std::move(counting), 1 << 20);
+  scoring::TfIdf tf_idf(1);
+
+  auto first = caching.search("Fox", tf_idf, 10);
+  auto second = caching.search("fox", tf_idf, 10);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(engine.searches, 1u);
+
+  // The number of results and the scoring function are part of the key
+  caching.search("fox", tf_idf, 5);
+  caching.search("fox", scoring::BM25(1, 1.0), 10);
+  EXPECT_EQ(engine.searches, 3u);
+}
+
+TEST(CachingEngineTest, RebuildInvalidates) {
+  auto counting = std::make_unique<CountingEngine>();
+  auto &engine = *counting;
+  queries::CachingEngine caching(std::move(counting), 1 << 20);
+  scoring::TfIdf tf_idf(1);
+
+  caching.search("fox", tf_idf, 10);
+  std::string path = "unused";
+  caching.indexDocuments(path);
+  caching.search("fox", tf_idf, 10);
+  EXPECT_EQ(engine.searches, 2u);
+}
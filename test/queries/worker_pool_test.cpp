@@ -0,0 +1,28 @@
+#include "queries/worker_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+TEST(WorkerPoolTest, RunsEveryIndexOnce) {
+  queries::WorkerPool pool(3);
+  EXPECT_EQ(pool.size(), 3u);
+  std::vector<std::atomic<int>> calls(1000);
+  pool.run(calls.size(), 4, [&calls](size_t i) { ++calls[i]; });
+  for (const auto& count : calls) EXPECT_EQ(count, 1);
+
+  // Without workers, the calling thread runs the whole job
+  queries::WorkerPool empty;
+  size_t sum = 0;
+  empty.run(10, 4, [&sum](size_t i) { sum += i; });
+  EXPECT_EQ(sum, 45u);
+}
+
+TEST(WorkerPoolTest, NestedRunsFinishOnBusyWorkers) {
+  queries::WorkerPool pool(2);
+  std::atomic<size_t> num_calls = 0;
+  // Every outer index occupies a thread and starts an inner job
+  pool.run(3, 3, [&](size_t) { pool.run(50, 3, [&](size_t) { ++num_calls; }); });
+  EXPECT_EQ(num_calls, 150u);
+}
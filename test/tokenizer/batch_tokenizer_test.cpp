@@ -0,0 +1,86 @@
+#include "tokenizer/batch_tokenizer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "tokenizer/simpletokenizer.hpp"
+#include "tokenizer/stemmingtokenizer.hpp"
+
+namespace tokenizer {
+
+static const std::vector<std::string> kTexts = {
+    "The quick brown fox jumps over the lazy dog",
+    "",
+    ",.!?;: running[] {}<>\\, jumped,!?;:\"() quickly.! !  ",
+    "the is and a an of over",
+    "Running RUNNING runNiNg running token1, token2.token3!token4?token5",
+};
+
+static std::vector<Document> makeBatch() {
+  std::vector<Document> docs;
+  for (size_t i = 0; i < kTexts.size(); ++i) {
+    docs.emplace_back(static_cast<uint32_t>(i + 1), kTexts[i].data(), kTexts[i].size(), nullptr);
+  }
+  return docs;
+}
+
+TEST(BatchTokenizerTest, MatchesStemmingTokenizer) {
+  auto docs = makeBatch();
+  BatchTokenizer batch_tokenizer(true, true);
+  TokenBatch tokens;
+  batch_tokenizer.tokenize(docs, tokens);
+
+  ASSERT_EQ(tokens.numDocuments(), kTexts.size());
+  for (size_t d = 0; d < kTexts.size(); ++d) {
+    StemmingTokenizer tokenizer(kTexts[d].data(), kTexts[d].size());
+    uint32_t i = tokens.doc_offsets[d];
+    for (auto token = tokenizer.nextToken(true); !token.empty();
+         token = tokenizer.nextToken(true)) {
+      ASSERT_LT(i, tokens.doc_offsets[d + 1]);
+      EXPECT_EQ(tokens.token(i), token);
+      EXPECT_EQ(tokens.doc_indices[i], d);
+      EXPECT_EQ(tokens.positions[i], i - tokens.doc_offsets[d]);
+      ++i;
+    }
+    EXPECT_EQ(i, tokens.doc_offsets[d + 1]);
+  }
+}
+
+TEST(BatchTokenizerTest, MatchesSimpleTokenizer) {
+  auto docs = makeBatch();
+  BatchTokenizer batch_tokenizer(false, false);
+  TokenBatch tokens;
+  batch_tokenizer.tokenize(docs, tokens);
+
+  std::vector<std::string> expected;
+  for (const auto &text : kTexts) {
+    SimpleTokenizer tokenizer(text.data(), text.size());
+    for (auto token = tokenizer.nextToken(false); !token.empty();
+         token = tokenizer.nextToken(false)) {
+      expected.push_back(token);
+    }
+  }
+
+  ASSERT_EQ(tokens.size(), expected.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    EXPECT_EQ(tokens.token(i), expected[i]);
+  }
+}
+
+TEST(BatchTokenizerTest, ReusesBatch) {
+  auto docs = makeBatch();
+  BatchTokenizer batch_tokenizer(true, true);
+  TokenBatch tokens;
+  batch_tokenizer.tokenize(docs, tokens);
+  size_t first_size = tokens.size();
+  batch_tokenizer.tokenize(docs, tokens);
+
+  EXPECT_EQ(tokens.size(), first_size);
+  EXPECT_EQ(tokens.numDocuments(), docs.size());
+  EXPECT_EQ(tokens.offsets.size(), tokens.size() + 1);
+  EXPECT_EQ(tokens.offsets.back(), tokens.bytes.size());
+}
+
+}  // namespace tokenizer
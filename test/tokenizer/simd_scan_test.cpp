@@ -0,0 +1,84 @@
+#include "tokenizer/simd_scan.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+namespace tokenizer {
+
+// Random bytes biased towards the interesting classes: letters, digits, the special token
+// characters, ASCII punctuation and bytes >= 128.
+static std::string randomText(size_t size, uint32_t seed) {
+  static const std::string kAlphabet = "aZqM09$%&+@ #.,-_[`{\t\n";
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> pick(0, 9);
+  std::string text(size, '\0');
+  for (auto &c : text) {
+    int kind = pick(gen);
+    if (kind < 6) {
+      c = kAlphabet[gen() % kAlphabet.size()];
+    } else {
+      c = static_cast<char>(gen() & 0xFF);
+    }
+  }
+  return text;
+}
+
+TEST(SimdScanTest, FindTokenBoundariesMatchesScalar) {
+  for (uint32_t seed = 0; seed < 20; ++seed) {
+    std::string text = randomText(1000, seed);
+    const char *end = text.data() + text.size();
+    for (const char *it = text.data(); it < end; ++it) {
+      EXPECT_EQ(findTokenBegin(it, end), scalar::findTokenBegin(it, end));
+      EXPECT_EQ(findTokenEnd(it, end), scalar::findTokenEnd(it, end));
+    }
+  }
+}
+
+TEST(SimdScanTest, EveryByteClassifiedLikeScalar) {
+  std::string text(256, '\0');
+  for (int i = 0; i < 256; ++i) text[i] = static_cast<char>(i);
+  const char *end = text.data() + text.size();
+  for (const char *it = text.data(); it < end; ++it) {
+    EXPECT_EQ(findTokenBegin(it, end), scalar::findTokenBegin(it, end));
+    EXPECT_EQ(findTokenEnd(it, end), scalar::findTokenEnd(it, end));
+  }
+}
+
+TEST(SimdScanTest, LongRuns) {
+  std::string text = std::string(100, ' ') + std::string(100, 'x') + std::string(70, '.');
+  const char *begin = text.data();
+  const char *end = text.data() + text.size();
+  EXPECT_EQ(findTokenBegin(begin, end), begin + 100);
+  EXPECT_EQ(findTokenEnd(begin + 100, end), begin + 200);
+  EXPECT_EQ(findTokenBegin(begin + 200, end), end);
+}
+
+TEST(SimdScanTest, ToLowerMatchesScalar) {
+  for (uint32_t seed = 0; seed < 20; ++seed) {
+    std::string text = randomText(333, seed);
+    for (size_t size = 0; size <= text.size(); size += 7) {
+      std::string expected(size, '\0');
+      std::string actual(size, '\0');
+      scalar::toLower(text.data(), size, expected.data());
+      toLower(text.data(), size, actual.data());
+      EXPECT_EQ(actual, expected);
+    }
+  }
+}
+
+TEST(SimdScanTest, IsAsciiMatchesScalar) {
+  std::string text(200, 'a');
+  for (size_t size = 0; size <= text.size(); ++size) {
+    EXPECT_TRUE(isAscii(text.data(), size));
+  }
+  for (size_t pos = 0; pos < text.size(); ++pos) {
+    text[pos] = static_cast<char>(0x80);
+    EXPECT_FALSE(isAscii(text.data(), text.size()));
+    EXPECT_EQ(isAscii(text.data(), pos), scalar::isAscii(text.data(), pos));
+    text[pos] = 'a';
+  }
+}
+
+}  // namespace tokenizer
@@ -0,0 +1,83 @@
+#include "tokenizer/stem_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tokenizer/stemmingtokenizer.hpp"
+
+namespace tokenizer {
+
+TEST(StemCacheTest, CountsHitsAndMisses) {
+  StemCache cache;
+  std::string stem;
+
+  EXPECT_FALSE(cache.lookup("running", stem));
+  cache.insert("running", "run");
+  EXPECT_TRUE(cache.lookup("running", stem));
+  EXPECT_EQ(stem, "run");
+
+  EXPECT_EQ(cache.getHits(), 1);
+  EXPECT_EQ(cache.getMisses(), 1);
+  EXPECT_NEAR(cache.getHitRate(), 0.5, 1e-9);
+
+  cache.resetStatistics();
+  EXPECT_EQ(cache.getHits(), 0);
+  EXPECT_EQ(cache.getMisses(), 0);
+}
+
+TEST(StemCacheTest, SkipsLongTokens) {
+  StemCache cache;
+  std::string long_token(StemCache::kMaxTokenLength + 1, 'a');
+  std::string stem;
+
+  cache.insert(long_token, long_token);
+  EXPECT_FALSE(cache.lookup(long_token, stem));
+  EXPECT_EQ(cache.getMisses(), 0);
+}
+
+TEST(StemCacheTest, CachedTokenizerMatchesUncached) {
+  const std::string input =
+      "Running runners ran quickly; the runner keeps running and jumping, jumps and jumped.";
+  StemCache cache(64);
+
+  for (int round = 0; round < 2; ++round) {
+    StemmingTokenizer uncached(input.c_str(), input.size());
+    StemmingTokenizer cached(input.c_str(), input.size(), &cache);
+    while (true) {
+      std::string expected = uncached.nextToken(true);
+      std::string actual = cached.nextToken(true);
+      EXPECT_EQ(actual, expected);
+      if (expected.empty() || actual.empty()) break;
+    }
+  }
+
+  EXPECT_GT(cache.getHits(), 0);
+}
+
+TEST(StemCacheTest, ConcurrentTokenizers) {
+  const std::string input = "connection connected connecting connections connective";
+  StemCache cache(16);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&input, &cache]() {
+      for (int round = 0; round < 1000; ++round) {
+        StemmingTokenizer tokenizer(input.c_str(), input.size(), &cache);
+        for (auto token = tokenizer.nextToken(false); !token.empty();
+             token = tokenizer.nextToken(false)) {
+          EXPECT_EQ(token, "connect");
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(cache.getHits() + cache.getMisses(), 4 * 1000 * 5);
+}
+
+}  // namespace tokenizer
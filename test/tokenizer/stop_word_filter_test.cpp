@@ -0,0 +1,38 @@
+#include "tokenizer/stop_word_filter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "tokenizer/tokenizer_rules.hpp"
+
+namespace tokenizer {
+
+TEST(StopWordFilterTest, ContainsAllStopWords) {
+  for (auto word : STOP_WORDS) {
+    EXPECT_TRUE(isStopWord(word)) << word;
+  }
+}
+
+TEST(StopWordFilterTest, RejectsOtherWords) {
+  EXPECT_FALSE(isStopWord(""));
+  for (std::string word : {"quick", "brown", "fox", "them1", "themselve", "yourselvesx",
+                           "ourselves ", "i2", "iii", "thee", "THE", "averyverylongword"}) {
+    bool listed = false;
+    for (auto stop_word : STOP_WORDS) listed |= stop_word == word;
+    EXPECT_EQ(isStopWord(word), listed) << word;
+  }
+}
+
+TEST(StopWordFilterTest, EvaluatedAtCompileTime) {
+  static constexpr std::array<std::string_view, 3> kWords = {"foo", "bar", "foobarbazqux"};
+  static constexpr StopWordFilter kFilter{kWords};
+
+  static_assert(kFilter.contains("foo"));
+  static_assert(kFilter.contains("foobarbazqux"));
+  static_assert(!kFilter.contains("foobarbazquy"));
+  static_assert(!kFilter.contains("ba"));
+  EXPECT_TRUE(kFilter.contains("bar"));
+}
+
+}  // namespace tokenizer
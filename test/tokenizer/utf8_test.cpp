@@ -0,0 +1,109 @@
+#include "tokenizer/utf8.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "tokenizer/batch_tokenizer.hpp"
+#include "tokenizer/stemmingtokenizer.hpp"
+#include "tokenizer/utf8tokenizer.hpp"
+
+namespace tokenizer {
+
+static std::vector<std::string> tokenize(const std::string &input, bool stem) {
+  Utf8Tokenizer tokenizer(input.c_str(), input.size(), stem);
+  std::vector<std::string> tokens;
+  for (auto token = tokenizer.nextToken(false); !token.empty();
+       token = tokenizer.nextToken(false)) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+TEST(Utf8Test, EncodeDecodeRoundTrip) {
+  for (char32_t cp : {0x41u, 0x7Fu, 0x80u, 0xE9u, 0x7FFu, 0x800u, 0x4E2Du, 0xFFFFu, 0x10000u,
+                      0x10FFFFu}) {
+    std::string encoded;
+    utf8::encode(cp, encoded);
+    const char *it = encoded.data();
+    EXPECT_EQ(utf8::decode(it, encoded.data() + encoded.size()), cp);
+    EXPECT_EQ(it, encoded.data() + encoded.size());
+  }
+}
+
+TEST(Utf8Test, InvalidSequencesAdvanceOneByte) {
+  // Stray continuation byte, truncated sequence, overlong '/' and an encoded surrogate.
+  for (std::string bytes : {"\x80", "\xC3", "\xC0\xAF", "\xED\xA0\x80"}) {
+    const char *it = bytes.data();
+    EXPECT_EQ(utf8::decode(it, bytes.data() + bytes.size()), utf8::kReplacement);
+    EXPECT_EQ(it, bytes.data() + 1);
+  }
+}
+
+TEST(Utf8Test, ClassifiesWordCharacters) {
+  for (char32_t cp :
+       {U'a', U'Z', U'7', U'$', U'é', U'ß', U'Ж', U'λ', U'א', U'ب', U'中', U'ー', U'한', U'́'}) {
+    EXPECT_TRUE(utf8::isWordChar(cp)) << static_cast<uint32_t>(cp);
+  }
+  for (char32_t cp : {U' ', U'.', U'-', U' ', U'«', U'€', U'—', U'。', U'\U0001F600',
+                      utf8::kReplacement}) {
+    EXPECT_FALSE(utf8::isWordChar(cp)) << static_cast<uint32_t>(cp);
+  }
+}
+
+TEST(Utf8Test, SimpleCaseFolding) {
+  EXPECT_EQ(utf8::foldCase(U'A'), U'a');
+  EXPECT_EQ(utf8::foldCase(U'É'), U'é');
+  EXPECT_EQ(utf8::foldCase(U'é'), U'é');
+  EXPECT_EQ(utf8::foldCase(U'×'), U'×');
+  EXPECT_EQ(utf8::foldCase(U'Ā'), U'ā');
+  EXPECT_EQ(utf8::foldCase(U'ā'), U'ā');
+  EXPECT_EQ(utf8::foldCase(U'Ÿ'), U'ÿ');
+  EXPECT_EQ(utf8::foldCase(U'Σ'), U'σ');
+  EXPECT_EQ(utf8::foldCase(U'Ώ'), U'ώ');
+  EXPECT_EQ(utf8::foldCase(U'Ж'), U'ж');
+  EXPECT_EQ(utf8::foldCase(U'Ё'), U'ё');
+  EXPECT_EQ(utf8::foldCase(U'Ա'), U'ա');
+  EXPECT_EQ(utf8::foldCase(U'Ạ'), U'ạ');
+  EXPECT_EQ(utf8::foldCase(U'Ａ'), U'ａ');
+  EXPECT_EQ(utf8::foldCase(U'中'), U'中');
+}
+
+TEST(Utf8Test, KeepsAndFoldsNonAsciiWords) {
+  EXPECT_EQ(tokenize("Café RÉSUMÉ naïve—Zürich", false),
+            (std::vector<std::string>{"café", "résumé", "naïve", "zürich"}));
+  EXPECT_EQ(tokenize("МОСКВА и Αθήνα, 東京!", false),
+            (std::vector<std::string>{"москва", "и", "αθήνα", "東京"}));
+  // Invalid bytes separate words like delimiters do.
+  EXPECT_EQ(tokenize("abc\xFF" "def", false), (std::vector<std::string>{"abc", "def"}));
+}
+
+TEST(Utf8Test, AsciiTextMatchesStemmingTokenizer) {
+  const std::string input =
+      "The quick brown foxes were JUMPING over the lazy dogs; e-mail me@example.com for 100%!";
+  for (bool skip_stop_words : {false, true}) {
+    StemmingTokenizer expected(input.c_str(), input.size());
+    Utf8Tokenizer actual(input.c_str(), input.size(), true);
+    while (true) {
+      std::string token = expected.nextToken(skip_stop_words);
+      EXPECT_EQ(actual.nextToken(skip_stop_words), token);
+      if (token.empty()) break;
+    }
+  }
+}
+
+TEST(Utf8Test, BatchTokenizerMatchesUtf8Tokenizer) {
+  const std::string input = "Über die Brücke, the RUNNING Straße läuft und läuft";
+  BatchTokenizer batch_tokenizer(true, true, nullptr, true);
+  TokenBatch batch;
+  batch_tokenizer.append(input.data(), input.size(), batch);
+
+  Utf8Tokenizer tokenizer(input.c_str(), input.size(), true);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    EXPECT_EQ(batch.token(i), tokenizer.nextToken(true));
+  }
+  EXPECT_EQ(tokenizer.nextToken(true), "");
+}
+
+}  // namespace tokenizer
@@ -0,0 +1,100 @@
+#include "algorithms/trigram/fuzzy/fuzzy_matcher.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "algorithms/trigram/fuzzy/levenshtein.hpp"
+
+namespace trigramlib {
+
+static uint32_t naiveDistance(const std::string &a, const std::string &b) {
+  std::vector<uint32_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+  for (size_t i = 1; i <= a.size(); ++i) {
+    uint32_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      uint32_t above = row[j];
+      row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1)});
+      diagonal = above;
+    }
+  }
+  return row[b.size()];
+}
+
+static std::string randomWord(std::mt19937 &gen, size_t max_length) {
+  std::string word(gen() % (max_length + 1), 'a');
+  for (auto &c : word) c = static_cast<char>('a' + gen() % 4);
+  return word;
+}
+
+TEST(LevenshteinTest, MatchesNaiveDistance) {
+  std::mt19937 gen(7);
+  for (int i = 0; i < 2000; ++i) {
+    std::string pattern = randomWord(gen, BoundedLevenshtein::kMaxPatternLength);
+    std::string text = randomWord(gen, 80);
+    uint32_t max_distance = gen() % 10;
+    uint32_t expected = std::min(naiveDistance(pattern, text), max_distance + 1);
+    EXPECT_EQ(BoundedLevenshtein(pattern).distance(text, max_distance), expected)
+        << pattern << " " << text;
+  }
+}
+
+TEST(FuzzyMatcherTest, CorrectsTypos) {
+  FuzzyMatcher matcher;
+  matcher.build({{"search", 10}, {"engine", 7}, {"fulltext", 3}, {"index", 5}, {"indent", 1}});
+  EXPECT_EQ(matcher.size(), 5);
+
+  EXPECT_EQ(matcher.correct("serch", 1), "search");
+  EXPECT_EQ(matcher.correct("engnie", 2), "engine");
+  EXPECT_EQ(matcher.correct("fulltxet", 2), "fulltext");
+  EXPECT_EQ(matcher.correct("indx", 1), "index");
+  // Unknown words and words beyond the distance stay as they are.
+  EXPECT_EQ(matcher.correct("banana", 2), "banana");
+  EXPECT_EQ(matcher.correct("engnie", 1), "engnie");
+  // Known and short words are never corrected.
+  EXPECT_EQ(matcher.correct("indent", 2), "indent");
+  EXPECT_EQ(matcher.correct("ix", 2), "ix");
+}
+
+TEST(FuzzyMatcherTest, PrefersFrequentTerms) {
+  FuzzyMatcher matcher;
+  matcher.build({{"cart", 1}, {"care", 9}, {"cars", 4}});
+  EXPECT_EQ(matcher.correct("carx", 1), "care");
+}
+
+TEST(FuzzyMatcherTest, FindsAllTermsWithinDistance) {
+  std::mt19937 gen(3);
+  std::vector<std::pair<std::string, uint32_t>> vocabulary;
+  for (int i = 0; i < 500; ++i) vocabulary.emplace_back(randomWord(gen, 10), gen() % 100);
+  std::sort(vocabulary.begin(), vocabulary.end());
+  vocabulary.erase(std::unique(vocabulary.begin(), vocabulary.end(),
+                               [](const auto &a, const auto &b) { return a.first == b.first; }),
+                   vocabulary.end());
+  FuzzyMatcher matcher;
+  matcher.build(vocabulary);
+
+  for (int i = 0; i < 300; ++i) {
+    std::string word = randomWord(gen, 10);
+    if (word.size() < FuzzyMatcher::kMinWordLength) continue;
+    // The best distance found by brute force.
+    uint32_t best = 3;
+    bool known = false;
+    for (const auto &[term, frequency] : vocabulary) {
+      best = std::min(best, naiveDistance(word, term));
+      known |= term == word;
+    }
+    std::string corrected(matcher.correct(word, 2));
+    if (known || best > 2) {
+      EXPECT_EQ(corrected, word);
+    } else {
+      EXPECT_EQ(naiveDistance(word, corrected), best) << word << " -> " << corrected;
+    }
+  }
+}
+
+}  // namespace trigramlib
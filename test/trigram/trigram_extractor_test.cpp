@@ -0,0 +1,94 @@
+#include "algorithms/trigram/parser/trigram_extractor.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "algorithms/trigram/parser/trigram_parser.hpp"
+
+namespace trigramlib {
+
+static std::vector<uint32_t> parse(const std::string &text, bool non_ascii) {
+  TrigramParser parser(text.data(), text.data() + text.size(), non_ascii);
+  std::vector<uint32_t> trigrams;
+  while (parser.hasNext()) trigrams.push_back(parser.next().getRawValue());
+  return trigrams;
+}
+
+// Mostly short words of letters with upper-case and special characters, separated by
+// punctuation, whitespace and bytes >= 128.
+static std::string randomText(size_t size, uint32_t seed) {
+  static const std::string kAlphabet = "abcXYZ09$%&+@";
+  static const std::string kDelimiters = " .,-\n";
+  std::mt19937 gen(seed);
+  std::string text(size, '\0');
+  for (auto &c : text) {
+    uint32_t kind = gen() % 10;
+    if (kind < 7) {
+      c = kAlphabet[gen() % kAlphabet.size()];
+    } else if (kind < 9) {
+      c = kDelimiters[gen() % kDelimiters.size()];
+    } else {
+      c = static_cast<char>(0x80 | (gen() & 0x7F));
+    }
+  }
+  return text;
+}
+
+TEST(TrigramExtractorTest, MatchesParser) {
+  std::vector<uint32_t> trigrams;
+  for (bool non_ascii : {false, true}) {
+    TrigramExtractor extractor(non_ascii);
+    for (uint32_t seed = 0; seed < 50; ++seed) {
+      std::string text = randomText(seed * 13, seed);
+      extractor.extract(text.data(), text.data() + text.size(), trigrams);
+      EXPECT_EQ(trigrams, parse(text, non_ascii)) << text;
+    }
+  }
+}
+
+TEST(TrigramExtractorTest, WordsAndOffsets) {
+  std::string text = "Hello, to you";
+  TrigramExtractor extractor;
+  std::vector<uint32_t> trigrams;
+  extractor.extract(text.data(), text.data() + text.size(), trigrams);
+
+  std::vector<uint32_t> expected = {Trigram("hel", 0).getRawValue(),
+                                    Trigram("ell", 1).getRawValue(),
+                                    Trigram("llo", 2).getRawValue(),
+                                    Trigram("to\0", 0).getRawValue(),
+                                    Trigram("you", 0).getRawValue()};
+  EXPECT_EQ(trigrams, expected);
+}
+
+TEST(TrigramExtractorTest, LongWords) {
+  std::string text = std::string(300, 'a') + " " + std::string(70, 'B') + "." + "zz";
+  TrigramExtractor extractor;
+  std::vector<uint32_t> trigrams;
+  extractor.extract(text.data(), text.data() + text.size(), trigrams);
+  EXPECT_EQ(trigrams, parse(text, false));
+  EXPECT_EQ(trigrams.size(), 298 + 68);
+}
+
+TEST(TrigramExtractorTest, FoldUnicode) {
+  std::string text = "ÉCOLE, Кот! 猫";
+  std::string folded;
+  foldUnicode(text.data(), text.data() + text.size(), folded);
+  // ASCII is kept, its letters are lower-cased by the parsers
+  EXPECT_EQ(folded, "éCOLE, кот! 猫");
+
+  // Every character keeps its own bytes, so distinct words share no trigram
+  std::vector<uint32_t> cat;
+  std::vector<uint32_t> dog;
+  TrigramExtractor extractor(true);
+  extractor.extract(folded.data() + folded.size() - 3, folded.data() + folded.size(), cat);
+  EXPECT_EQ(cat.size(), 1u);
+  std::string other = "犬";
+  extractor.extract(other.data(), other.data() + other.size(), dog);
+  ASSERT_EQ(dog.size(), 1u);
+  EXPECT_NE(cat, dog);
+}
+
+}  // namespace trigramlib
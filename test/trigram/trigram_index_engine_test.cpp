@@ -0,0 +1,112 @@
+#include "algorithms/trigram/trigram_index_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "parquet_documents.hpp"
+#include "scoring/bm25.hpp"
+#include "tokenizer/utf8.hpp"
+
+namespace {
+
+/// Indexes the documents in a directory of their own below directory, along with filler
+/// documents 100 to 139, so the trigrams of the others aren't dropped as too frequent.
+void index(TrigramIndexEngine &engine, const test::TemporaryDirectory &directory,
+           const std::string &name, std::vector<std::pair<DocumentID, std::string>> documents) {
+  static const std::string kLetters = "cdfghkmpqtvxy";
+  for (DocumentID doc_id = 100; doc_id < 140; ++doc_id) {
+    documents.emplace_back(doc_id,
+                           std::string{'k', kLetters[doc_id % 13], kLetters[doc_id / 13 % 13], 'x'});
+  }
+  auto data_path = directory.path() / name;
+  std::filesystem::create_directories(data_path);
+  test::writeDocuments(data_path / "documents.parquet", documents);
+  std::string path = data_path.string();
+  engine.indexDocuments(path);
+}
+
+/// Get the ids of all documents sharing a trigram with the query, sorted.
+std::vector<DocumentID> matches(TrigramIndexEngine &engine, const std::string &query) {
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  auto doc_ids = test::ids(engine.search(query, bm25, 100));
+  std::sort(doc_ids.begin(), doc_ids.end());
+  return doc_ids;
+}
+
+}  // namespace
+
+TEST(TrigramIndexEngineTest, DeleteUpdateAndCompact) {
+  test::TemporaryDirectory directory("trigram_index_engine_test");
+  // 0 and 4 are gaps of the document ids
+  TrigramIndexEngine engine;
+  index(engine, directory, "documents",
+        {{1, "zebra crossing"}, {2, "zebra"}, {3, "walrus"}, {5, "walrus zebra"}});
+  EXPECT_EQ(engine.getDocumentCount(), 44u);
+
+  EXPECT_FALSE(engine.deleteDocument(0));
+  EXPECT_FALSE(engine.deleteDocument(4));
+  EXPECT_FALSE(engine.deleteDocument(1000));
+  EXPECT_EQ(engine.getDocumentCount(), 44u);
+
+  uint64_t version = engine.getIndexVersion();
+  ASSERT_TRUE(engine.deleteDocument(2));
+  EXPECT_FALSE(engine.deleteDocument(2));
+  EXPECT_GT(engine.getIndexVersion(), version);
+  EXPECT_EQ(matches(engine, "zebra"), (std::vector<DocumentID>{1, 5}));
+  // The statistics are those of the remaining documents
+  TrigramIndexEngine remaining;
+  index(remaining, directory, "remaining",
+        {{1, "zebra crossing"}, {3, "walrus"}, {5, "walrus zebra"}});
+  EXPECT_EQ(engine.getDocumentCount(), remaining.getDocumentCount());
+  EXPECT_DOUBLE_EQ(engine.getAvgDocumentLength(), remaining.getAvgDocumentLength());
+
+  // The occurences of document 2 are removed, it stays deleted
+  uint64_t footprint = engine.footprint_size();
+  engine.compact();
+  EXPECT_LT(engine.footprint_size(), footprint);
+  EXPECT_EQ(matches(engine, "zebra"), (std::vector<DocumentID>{1, 5}));
+  EXPECT_FALSE(engine.deleteDocument(2));
+
+  // Document 1 is replaced, 4 falls into a gap and 7 is beyond the old ids
+  auto update = directory.path() / "update" / "documents.parquet";
+  std::filesystem::create_directories(update.parent_path());
+  test::writeDocuments(update, {{1, "walrus"}, {4, "zebra"}, {7, "narwhal"}});
+  engine.updateDocuments(update.string());
+  EXPECT_EQ(matches(engine, "zebra"), (std::vector<DocumentID>{4, 5}));
+  EXPECT_EQ(matches(engine, "walrus"), (std::vector<DocumentID>{1, 3, 5}));
+  EXPECT_EQ(matches(engine, "narwhal"), (std::vector<DocumentID>{7}));
+
+  TrigramIndexEngine updated;
+  index(updated, directory, "updated",
+        {{1, "walrus"}, {3, "walrus"}, {4, "zebra"}, {5, "walrus zebra"}, {7, "narwhal"}});
+  EXPECT_EQ(engine.getDocumentCount(), updated.getDocumentCount());
+  EXPECT_NEAR(engine.getAvgDocumentLength(), updated.getAvgDocumentLength(), 1e-9);
+}
+
+TEST(TrigramIndexEngineTest, UnicodeCharactersDontCollide) {
+  test::TemporaryDirectory directory("trigram_index_engine_test");
+  // Every word is the same two Cyrillic letters and a CJK character of its own
+  std::vector<std::pair<DocumentID, std::string>> documents;
+  for (DocumentID doc_id = 1; doc_id <= 300; ++doc_id) {
+    std::string content = "жу";
+    tokenizer::utf8::encode(0x4E00 + doc_id, content);
+    documents.emplace_back(doc_id, content);
+  }
+  TrigramIndexEngine engine(true);
+  index(engine, directory, "documents", documents);
+
+  // The trigrams of its own character make every document the single best match
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+  for (const auto &[doc_id, content] : documents) {
+    auto results = engine.search(content, bm25, 2);
+    ASSERT_FALSE(results.empty());
+    EXPECT_EQ(results[0].first, doc_id);
+    if (results.size() > 1) {
+      EXPECT_LT(results[1].second, results[0].second) << "document " << doc_id;
+    }
+  }
+}
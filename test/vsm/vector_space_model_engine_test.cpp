@@ -0,0 +1,93 @@
+#include "algorithms/vsm/vector_space_model_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "algorithms/vsm/cosine_scan.hpp"
+#include "parquet_documents.hpp"
+#include "scoring/bm25.hpp"
+
+namespace {
+
+/// Indexes the documents with a fresh engine.
+void index(VectorSpaceModelEngine &engine, const test::TemporaryDirectory &directory,
+           const std::vector<std::pair<DocumentID, std::string>> &documents) {
+  test::writeDocuments(directory.path() / "documents.parquet", documents);
+  std::string data_path = directory.path().string();
+  engine.indexDocuments(data_path);
+}
+
+}  // namespace
+
+TEST(VectorSpaceModelEngineTest, RanksByCosine) {
+  test::TemporaryDirectory directory("vector_space_model_engine_test");
+  VectorSpaceModelEngine engine;
+  index(engine, directory,
+        {{1, "zebra"}, {2, "zebra walrus"}, {3, "zebra walrus narwhal yak"}, {4, "walrus"}});
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+
+  // The shorter a document containing zebra, the closer it is to the query
+  auto results = engine.search("zebra", bm25, 10);
+  EXPECT_EQ(test::ids(results), (std::vector<DocumentID>{1, 2, 3}));
+  EXPECT_NEAR(results[0].second, 1.0, 1e-5);
+  // zebra and walrus are equally frequent, so they weigh the same
+  EXPECT_NEAR(results[1].second, 1.0 / std::sqrt(2.0), 1e-5);
+
+  EXPECT_EQ(test::ids(engine.search("walrus zebra", bm25, 1)), (std::vector<DocumentID>{2}));
+  EXPECT_EQ(engine.getDocumentCount(), 4u);
+  EXPECT_DOUBLE_EQ(engine.getAvgDocumentLength(), 2.0);
+}
+
+TEST(VectorSpaceModelEngineTest, NoIndexedQueryTerm) {
+  test::TemporaryDirectory directory("vector_space_model_engine_test");
+  VectorSpaceModelEngine engine;
+  index(engine, directory, {{1, "zebra"}, {2, "walrus"}});
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+
+  EXPECT_TRUE(engine.search("unicorn", bm25, 10).empty());
+  EXPECT_TRUE(engine.search("", bm25, 10).empty());
+  EXPECT_TRUE(engine.search("zebra", bm25, 0).empty());
+}
+
+TEST(VectorSpaceModelEngineTest, SparseDocumentIds) {
+  test::TemporaryDirectory directory("vector_space_model_engine_test");
+  VectorSpaceModelEngine engine;
+  // The ids exceed the number of documents by far
+  index(engine, directory, {{7, "zebra walrus"}, {1'000'000, "zebra"}, {65'537, "walrus"}});
+  scoring::BM25 bm25(engine.getDocumentCount(), engine.getAvgDocumentLength());
+
+  EXPECT_EQ(test::ids(engine.search("zebra", bm25, 10)),
+            (std::vector<DocumentID>{1'000'000, 7}));
+  EXPECT_EQ(test::ids(engine.search("walrus", bm25, 10)), (std::vector<DocumentID>{65'537, 7}));
+}
+
+TEST(VectorSpaceModelEngineTest, KernelsMatchScalar) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<DocumentID> pick_doc(0, 999);
+  // Few distinct weights, so many documents tie
+  std::uniform_int_distribution<int> pick_weight(0, 7);
+
+  for (uint32_t round = 0; round < 20; ++round) {
+    size_t num_postings = 1 + round * 37;
+    std::vector<DocumentID> docs(num_postings);
+    std::vector<float> weights(num_postings);
+    for (size_t i = 0; i < num_postings; ++i) {
+      docs[i] = pick_doc(gen);
+      weights[i] = static_cast<float>(pick_weight(gen)) / 4.0f;
+    }
+
+    std::vector<float> scores(1000 + round, 0.0f);
+    std::vector<float> scalar_scores(scores.size(), 0.0f);
+    vsm::accumulate(docs.data(), weights.data(), num_postings, 0.5f, scores.data());
+    vsm::scalar::accumulate(docs.data(), weights.data(), num_postings, 0.5f,
+                            scalar_scores.data());
+    ASSERT_EQ(scores, scalar_scores);
+
+    for (uint32_t num_results : {0u, 1u, 10u, 100u, 2000u}) {
+      EXPECT_EQ(vsm::topK(scores, num_results), vsm::scalar::topK(scores, num_results));
+    }
+  }
+}